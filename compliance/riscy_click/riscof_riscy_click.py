@@ -69,6 +69,8 @@ class riscy_click(pluginTemplate):
             self.isa += 'i'
         if "M" in ispec["ISA"]:
             self.isa += 'm'
+        if "A" in ispec["ISA"]:
+            self.isa += 'a'
         if "C" in ispec["ISA"]:
             self.isa += 'c'
 
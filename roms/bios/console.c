@@ -1,6 +1,7 @@
 #include "peripherals/keyboard.h"
 #include "peripherals/display.h"
 #include "peripherals/framebuffer.h"
+#include "peripherals/timer.h"
 #include "console.h"
 
 #include <stdint.h>
@@ -55,7 +56,40 @@ const char TRANSLATION_TABLE[256] = {
     '\x00' , '\x00' , '\x00' , '\x00' , '\x00' , '\x00' , '\x00' , '\x00' ,
 };
 
-char con_getch(void) {
+
+//
+// Cursor
+//
+
+static const uint32_t CursorBlinkMs = 500;
+
+static volatile uint8_t cursor_x     = 0;
+static volatile uint8_t cursor_y     = 0;
+static volatile bool    cursor_shown = false;
+static volatile char    cursor_under = ' ';  // character covered by the cursor while shown
+
+// runs from the timer interrupt while con_getch waits for a key
+static void cursor_blink(void) {
+    if (cursor_shown) {
+        fb_write(cursor_x, cursor_y, cursor_under);
+    } else {
+        cursor_under = fb_read(cursor_x, cursor_y);
+        fb_write(cursor_x, cursor_y, '_');
+    }
+    cursor_shown = !cursor_shown;
+}
+
+void con_set_cursor(uint8_t x, uint8_t y) {
+    cursor_x = x;
+    cursor_y = y;
+}
+
+
+//
+// Input
+//
+
+static char translate(void) {
     while (true) {
         kbd_event_t e = kbd_wait();
 
@@ -107,3 +141,17 @@ char con_getch(void) {
         }
     }
 }
+
+// the cursor blinks while waiting, and is put away before the key is returned
+char con_getch(void) {
+    int blink = tmr_start(CursorBlinkMs, cursor_blink);
+    char c = translate();
+    tmr_stop(blink);
+
+    if (cursor_shown) {
+        fb_write(cursor_x, cursor_y, cursor_under);
+        cursor_shown = false;
+    }
+
+    return c;
+}
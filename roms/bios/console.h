@@ -1,3 +1,6 @@
 #pragma once
 
+#include <stdint.h>
+
+void con_set_cursor(uint8_t x, uint8_t y);
 char con_getch(void);
@@ -3,6 +3,7 @@
 #include "peripherals/interrupt.h"
 #include "peripherals/keyboard.h"
 #include "peripherals/switches.h"
+#include "peripherals/timer.h"
 #include "console.h"
 
 #include <stdint.h>
@@ -12,6 +13,7 @@ int main() {
     dsp_init();
     kbd_init();
     sw_init();
+    tmr_init();
     fb_init();
 
     dsp_enable();
@@ -29,6 +31,7 @@ int main() {
     x = 0;
     y = 0;
     for (;;) {
+        con_set_cursor(x, y);
         char c = con_getch();
 
         switch (c) {
@@ -1,10 +1,15 @@
 #include "interrupt.h"
+#include "display.h"
 
 #define IRQ_BASE 0xFFFF0000
 
 #define PORT_PENDING ((volatile interrupt_t * const)(IRQ_BASE+0x00))
 #define PORT_ENABLED ((volatile interrupt_t * const)(IRQ_BASE+0x04))
 #define PORT_ACTIVE  ((volatile interrupt_t * const)(IRQ_BASE+0x08))
+#define PORT_CLAIM   ((volatile uint32_t    * const)(IRQ_BASE+0x0C))
+
+#define MCAUSE_TIMER    0x80000007
+#define MCAUSE_EXTERNAL 0x8000000B
 
 //
 // Interrupt Handlers
@@ -13,6 +18,20 @@
 extern void on_uart_interrupt     (void);
 extern void on_keyboard_interrupt (void);
 extern void on_switch_interrupt   (void);
+extern void on_timer_interrupt    (void);
+
+static void on_unhandled_interrupt(void) {
+}
+
+// indexed by claim ID (source bit + 1)
+static void (* const HANDLERS[])(void) = {
+    on_unhandled_interrupt,  // none
+    on_unhandled_interrupt,  // IRQ_UART
+    on_keyboard_interrupt,   // IRQ_KEYBOARD
+    on_switch_interrupt      // IRQ_SWITCHES
+};
+
+#define HANDLER_COUNT (sizeof(HANDLERS) / sizeof(HANDLERS[0]))
 
 
 //
@@ -56,25 +75,44 @@ void irq_disable(interrupt_t i) {
 // Wait for Interrupts
 //
 
+// sleeps until an enabled interrupt is pending, even with interrupts globally
+// disabled, so callers can check their wake condition with interrupts off and
+// not lose an interrupt that lands between the check and the wfi
 void irq_wait(void) {
-//    __asm__ volatile ("wfi");
-    __asm__ volatile ("nop");
+    __asm__ volatile ("wfi");
 }
 
 
 //
-// Interrupt Handler
+// Interrupt Dispatch
 //
 
-void on_interrupt(void) {
-    for (interrupt_t active = *PORT_ACTIVE; active != 0; active = *PORT_ACTIVE) {
-        // if ((active & IRQ_UART) == IRQ_UART)
-        //     on_uart_interrupt();
-
-        if ((active & IRQ_KEYBOARD) == IRQ_KEYBOARD)
-            on_keyboard_interrupt();
+// external interrupts arrive here straight from the trap vector
+void on_external_interrupt(void) {
+    for (uint32_t id = *PORT_CLAIM; id != 0; id = *PORT_CLAIM) {
+        if (id < HANDLER_COUNT)
+            HANDLERS[id]();
+        *PORT_CLAIM = id;
+    }
+}
 
-        if ((active & IRQ_SWITCHES) == IRQ_SWITCHES)
-            on_switch_interrupt();
+// everything else (exceptions, or all traps if mtvec is direct)
+void on_interrupt(void) {
+    uint32_t mcause;
+    __asm__ volatile ("csrr %0, mcause" : "=r"(mcause));
+
+    if (mcause == MCAUSE_TIMER) {
+        on_timer_interrupt();
+    } else if (mcause == MCAUSE_EXTERNAL) {
+        on_external_interrupt();
+    } else {
+        // returning would re-execute the faulting instruction forever (e.g. a misaligned access on a core
+        // built with TRAP_MISALIGNED), so show the cause and address and stop on an undecodable instruction
+        uint32_t mepc;
+        __asm__ volatile ("csrr %0, mepc" : "=r"(mepc));
+        dsp_write((mcause << 28) | (mepc & 0x0FFFFFFF));
+        dsp_enable();
+        for (;;)
+            __asm__ volatile (".word 0xFFFFFFFF");
     }
 }
@@ -25,5 +25,6 @@ void        irq_disable     (interrupt_t i);
 // Wait for Interrupts
 void        irq_wait        (void);
 
-// Primary Interrupt Handler
-void        on_interrupt    (void);
+// Interrupt Dispatch
+void        on_interrupt          (void);
+void        on_external_interrupt (void);
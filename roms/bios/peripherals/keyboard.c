@@ -15,12 +15,23 @@
 // Interrupt Handling
 //
 
-static volatile kbd_event_t next_key        = 0;
-static volatile int         interrupt_count = 0;
+// single producer (the interrupt handler), single consumer (kbd_wait) ring buffer, so neither side locks
+#define QUEUE_SIZE (16)
+
+static kbd_event_t       queue[QUEUE_SIZE];
+static volatile uint32_t queue_head      = 0;  // next event to take
+static volatile uint32_t queue_tail      = 0;  // next free slot
+static volatile int      interrupt_count = 0;
 
 void on_keyboard_interrupt(void) {
-    interrupt_count++;
-    next_key = kbd_read();
+    __atomic_fetch_add(&interrupt_count, 1, __ATOMIC_RELAXED);
+
+    kbd_event_t e    = kbd_read();
+    uint32_t    tail = queue_tail;
+    if (tail - __atomic_load_n(&queue_head, __ATOMIC_ACQUIRE) < QUEUE_SIZE) {
+        queue[tail % QUEUE_SIZE] = e;
+        __atomic_store_n(&queue_tail, tail + 1, __ATOMIC_RELEASE);
+    }
 }
 
 
@@ -29,6 +40,7 @@ void on_keyboard_interrupt(void) {
 //
 
 void kbd_init(void) {
+    irq_enable(IRQ_KEYBOARD);
 }
 
 
@@ -41,18 +53,24 @@ kbd_event_t kbd_read(void) {
 }
 
 kbd_event_t kbd_wait(void) {
-    irq_enable(IRQ_KEYBOARD);
-    while (interrupt_count == 0) {
-        irq_wait();
+    uint32_t head = queue_head;
+
+    while (__atomic_load_n(&queue_tail, __ATOMIC_ACQUIRE) == head) {
+        _global_disable_interrupts();
+        if (queue_tail == head)
+            irq_wait();
+        _global_enable_interrupts();
     }
-    irq_disable(IRQ_KEYBOARD);
 
-    char c = fb_read(10+interrupt_count, FrameBufferHeight-1);
+    // interrupts seen since the last key was taken (amoswap, so none are lost to the handler)
+    int count = __atomic_exchange_n(&interrupt_count, 0, __ATOMIC_RELAXED);
+    char c = fb_read(10+count, FrameBufferHeight-1);
     c = (c == ' ') ? 'A' : (c+1);
-    fb_write(10+interrupt_count, FrameBufferHeight-1, c);
-    interrupt_count = 0;
+    fb_write(10+count, FrameBufferHeight-1, c);
 
-    return next_key;
+    kbd_event_t e = queue[head % QUEUE_SIZE];
+    __atomic_store_n(&queue_head, head + 1, __ATOMIC_RELEASE);
+    return e;
 }
 
 
@@ -0,0 +1,150 @@
+#include "timer.h"
+#include "interrupt.h"
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define TMR_BASE 0xFFFF0600
+
+#define PORT_MTIMECMP  ((volatile uint32_t * const)(TMR_BASE+0x08))
+#define PORT_MTIMECMPH ((volatile uint32_t * const)(TMR_BASE+0x0C))
+
+#define TIMERS 4
+#define NEVER  UINT64_MAX
+
+
+//
+// Timer State
+//
+
+typedef struct {
+    tmr_callback_t callback;  // NULL if unused
+    uint64_t       period;    // in ticks
+    uint64_t       next;      // next expiry
+} soft_timer_t;
+
+static volatile soft_timer_t timers[TIMERS] = { 0 };
+static volatile uint64_t     sleep_until    = NEVER;
+
+// point mtimecmp at the earliest deadline, or never
+static void reprogram(void) {
+    uint64_t next = sleep_until;
+    for (int i=0; i<TIMERS; i++)
+        if (timers[i].callback && timers[i].next < next)
+            next = timers[i].next;
+
+    // raise the high word first so no intermediate value fires early
+    *PORT_MTIMECMPH = UINT32_MAX;
+    *PORT_MTIMECMP  = (uint32_t)next;
+    *PORT_MTIMECMPH = (uint32_t)(next >> 32);
+}
+
+
+//
+// Interrupt Handler
+//
+
+void on_timer_interrupt(void) {
+    uint64_t now = tmr_now();
+
+    for (int i=0; i<TIMERS; i++) {
+        if (timers[i].callback && timers[i].next <= now) {
+            timers[i].callback();
+            // skip missed periods rather than firing back to back
+            timers[i].next += timers[i].period;
+            if (timers[i].next <= now)
+                timers[i].next = now + timers[i].period;
+        }
+    }
+
+    if (sleep_until <= now)
+        sleep_until = NEVER;
+
+    reprogram();
+}
+
+
+//
+// Initialization
+//
+
+void tmr_init(void) {
+    reprogram();
+    __asm__ volatile ("csrs mie, %0" : : "r"(0x80));
+}
+
+
+//
+// Time
+//
+
+uint64_t tmr_now(void) {
+    uint32_t hi, lo, hi2;
+    do {
+        __asm__ volatile ("csrr %0, timeh" : "=r"(hi));
+        __asm__ volatile ("csrr %0, time"  : "=r"(lo));
+        __asm__ volatile ("csrr %0, timeh" : "=r"(hi2));
+    } while (hi != hi2);
+    return ((uint64_t)hi << 32) | lo;
+}
+
+uint64_t tmr_deadline(uint32_t ms) {
+    return tmr_now() + (uint64_t)ms * TimerTicksPerMs;
+}
+
+bool tmr_expired(uint64_t deadline) {
+    return tmr_now() >= deadline;
+}
+
+
+//
+// Periodic Timers
+//
+
+int tmr_start(uint32_t period_ms, tmr_callback_t callback) {
+    _global_disable_interrupts();
+    int timer = -1;
+    for (int i=0; i<TIMERS && timer < 0; i++) {
+        if (!timers[i].callback) {
+            timers[i].period   = (uint64_t)period_ms * TimerTicksPerMs;
+            timers[i].next     = tmr_now() + timers[i].period;
+            timers[i].callback = callback;
+            timer = i;
+        }
+    }
+    reprogram();
+    _global_enable_interrupts();
+    return timer;
+}
+
+void tmr_stop(int timer) {
+    if (timer < 0 || timer >= TIMERS)
+        return;
+
+    _global_disable_interrupts();
+    timers[timer].callback = 0;
+    reprogram();
+    _global_enable_interrupts();
+}
+
+
+//
+// Sleeping
+//
+
+void tmr_sleep(uint32_t ms) {
+    uint64_t deadline = tmr_deadline(ms);
+
+    // check and wait with interrupts off, see irq_wait
+    _global_disable_interrupts();
+    while (!tmr_expired(deadline)) {
+        if (deadline < sleep_until) {
+            sleep_until = deadline;
+            reprogram();
+        }
+        irq_wait();
+        _global_enable_interrupts();
+        _global_disable_interrupts();
+    }
+    _global_enable_interrupts();
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// mtime counts cpu cycles
+static const uint32_t TimerTicksPerMs = 50000;
+
+// Periodic callbacks run from the timer interrupt
+typedef void (*tmr_callback_t)(void);
+
+// Initialization
+void     tmr_init     (void);
+
+// Time
+uint64_t tmr_now      (void);
+uint64_t tmr_deadline (uint32_t ms);
+bool     tmr_expired  (uint64_t deadline);
+
+// Periodic Timers
+int      tmr_start    (uint32_t period_ms, tmr_callback_t callback);
+void     tmr_stop     (int timer);
+
+// Sleeping
+void     tmr_sleep    (uint32_t ms);
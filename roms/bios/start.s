@@ -19,8 +19,9 @@
 .global _start
 _start:
 setup_traps:
-    # point all traps at _trap_handler
-    la t0, _trap_handler
+    # vector traps through _trap_vector
+    la t0, _trap_vector
+    ori t0, t0, 1
     csrw mtvec, t0
 
     # set pointers
@@ -84,9 +85,7 @@ _global_disable_interrupts:
     csrw mstatus, t0
     ret
 
-.align 4
-.global _trap_handler
-_trap_handler:
+.macro trap_entry handler
     addi sp, sp, -64
 
     sw ra, 0(sp)
@@ -106,7 +105,7 @@ _trap_handler:
     sw a6, 56(sp)
     sw a7, 60(sp)
 
-    jal on_interrupt
+    jal \handler
 
     lw a7, 60(sp)
     lw a6, 56(sp)
@@ -127,3 +126,40 @@ _trap_handler:
 
     addi sp, sp, 64
     mret
+.endm
+
+    # vectored mode: exceptions use entry 0, interrupts entry mcause
+    # (entries must be 4 bytes, so no compressed jumps)
+.align 4
+.global _trap_vector
+_trap_vector:
+.option push
+.option norvc
+    j _trap_handler             # 0: exceptions
+    j _trap_handler             # 1: supervisor software
+    j _trap_handler             # 2
+    j _trap_handler             # 3: machine software
+    j _trap_handler             # 4
+    j _trap_handler             # 5: supervisor timer
+    j _trap_handler             # 6
+    j _timer_trap_handler       # 7: machine timer
+    j _trap_handler             # 8
+    j _trap_handler             # 9: supervisor external
+    j _trap_handler             # 10
+    j _external_trap_handler    # 11: machine external
+.option pop
+
+.align 4
+.global _trap_handler
+_trap_handler:
+    trap_entry on_interrupt
+
+.align 4
+.global _timer_trap_handler
+_timer_trap_handler:
+    trap_entry on_timer_interrupt
+
+.align 4
+.global _external_trap_handler
+_external_trap_handler:
+    trap_entry on_external_interrupt
@@ -98,7 +98,7 @@ int main(int argc, char** argv)
         ImGui::SetNextWindowSize(viewport->Size);
 
         {
-            ImGui::Begin("Riscy Click", NULL, ImGuiWindowFlags_NoDecoration | ImGuiWindowFlags_NoMove | ImGuiWindowFlags_NoResize | ImGuiWindowFlags_NoSavedSettings);
+            ImGui::Begin("Riscy Click", NULL, ImGuiWindowFlags_NoDecoration | ImGuiWindowFlags_NoMove | ImGuiWindowFlags_NoResize | ImGuiWindowFlags_NoSavedSettings | ImGuiWindowFlags_NoBringToFrontOnFocus);
 
             // Draw Model
             sim_draw(g_model, ImGui::GetIO().DeltaTime);
@@ -0,0 +1,110 @@
+#include <atomic>
+
+#include "sim_heatmap.h"
+#include "sim_probe.h"
+
+//
+// Regions are indexed by word, so every access costs a chip select test and
+// an increment.  Regions larger than the tracked window alias onto it.
+//
+
+static const heat_region_t REGIONS[] = {
+    { "bios", 0x00000000, 1024,  32, PROBE_CS_BIOS },
+    { "ram",  0x10000000, 1024,  32, PROBE_CS_RAM  },
+    { "vram", 0x20000000, 4096, 128, PROBE_CS_VRAM },
+    { "mmio", 0xFFFF0000,  448,  64, PROBE_CS_IRQ | PROBE_CS_UART | PROBE_CS_DISPLAY | PROBE_CS_SWITCHES | PROBE_CS_KEYBOARD | PROBE_CS_VGA | PROBE_CS_TIMER }
+};
+
+static const int REGION_COUNT = sizeof(REGIONS) / sizeof(REGIONS[0]);
+
+struct sim_heatmap {
+    uint32_t          sample_period;
+    uint32_t          sample_countdown;
+    uint32_t*         reads[REGION_COUNT];
+    uint32_t*         writes[REGION_COUNT];
+    std::atomic<bool> reset_requested;  // set by the UI, cleared by the simulation thread
+};
+
+static void heat_clear(sim_heatmap_t* heatmap) {
+    for (int i=0; i<REGION_COUNT; i++) {
+        for (uint32_t j=0; j<REGIONS[i].words; j++) {
+            heatmap->reads[i][j]  = 0;
+            heatmap->writes[i][j] = 0;
+        }
+    }
+}
+
+sim_heatmap_t *heat_create(uint32_t sample_period) {
+    sim_heatmap_t *heatmap = new sim_heatmap_t;
+    heatmap->sample_period    = sample_period ? sample_period : 1;
+    heatmap->sample_countdown = heatmap->sample_period;
+    heatmap->reset_requested  = false;
+    for (int i=0; i<REGION_COUNT; i++) {
+        heatmap->reads[i]  = new uint32_t[REGIONS[i].words] { 0 };
+        heatmap->writes[i] = new uint32_t[REGIONS[i].words] { 0 };
+    }
+    return heatmap;
+}
+
+void heat_destroy(sim_heatmap_t* heatmap) {
+    for (int i=0; i<REGION_COUNT; i++) {
+        delete [] heatmap->reads[i];
+        delete [] heatmap->writes[i];
+    }
+    delete heatmap;
+}
+
+void heat_tick(sim_heatmap_t* heatmap, uint32_t addr, bool read_enable, uint8_t write_mask, uint16_t chip_select) {
+    // the counters are only ever touched on the simulation thread, so a reset from the UI waits for the next tick
+    if (heatmap->reset_requested.load(std::memory_order_relaxed) && heatmap->reset_requested.exchange(false))
+        heat_clear(heatmap);
+
+    // only every Nth cycle is sampled
+    if (--heatmap->sample_countdown != 0)
+        return;
+    heatmap->sample_countdown = heatmap->sample_period;
+
+    if (!read_enable && write_mask == 0)
+        return;
+
+    for (int i=0; i<REGION_COUNT; i++) {
+        if ((chip_select & REGIONS[i].chip_select) == 0)
+            continue;
+
+        uint32_t word = ((addr - REGIONS[i].base) >> 2) % REGIONS[i].words;
+        if (read_enable)     heatmap->reads[i][word]++;
+        if (write_mask != 0) heatmap->writes[i][word]++;
+        return;
+    }
+}
+
+void heat_reset(sim_heatmap_t* heatmap) {
+    heatmap->reset_requested = true;
+}
+
+void heat_export(sim_heatmap_t* heatmap, FILE* out) {
+    fprintf(out, "region,address,row,column,reads,writes\n");
+    for (int i=0; i<REGION_COUNT; i++) {
+        for (uint32_t j=0; j<REGIONS[i].words; j++) {
+            if (heatmap->reads[i][j] == 0 && heatmap->writes[i][j] == 0)
+                continue;
+            fprintf(out, "%s,0x%08X,%u,%u,%u,%u\n", REGIONS[i].name, REGIONS[i].base + (j << 2), j / REGIONS[i].columns, j % REGIONS[i].columns, heatmap->reads[i][j], heatmap->writes[i][j]);
+        }
+    }
+}
+
+int heat_region_count() {
+    return REGION_COUNT;
+}
+
+const heat_region_t* heat_region(int region) {
+    return &REGIONS[region];
+}
+
+const uint32_t* heat_reads(sim_heatmap_t* heatmap, int region) {
+    return heatmap->reads[region];
+}
+
+const uint32_t* heat_writes(sim_heatmap_t* heatmap, int region) {
+    return heatmap->writes[region];
+}
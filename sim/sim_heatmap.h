@@ -0,0 +1,31 @@
+#ifndef __SIM_HEATMAP_H
+#define __SIM_HEATMAP_H
+
+#include <cstdint>
+#include <cstdio>
+
+typedef struct sim_heatmap sim_heatmap_t;
+
+typedef struct {
+    const char* name;        // region name
+    uint32_t    base;        // byte address of the first word
+    uint32_t    words;       // number of words tracked
+    uint32_t    columns;     // words per heatmap row
+    uint16_t    chip_select; // chip select bits that map to this region
+} heat_region_t;
+
+sim_heatmap_t *heat_create(uint32_t sample_period);
+void heat_destroy(sim_heatmap_t* heatmap);
+
+void heat_tick(sim_heatmap_t* heatmap, uint32_t addr, bool read_enable, uint8_t write_mask, uint16_t chip_select);
+void heat_reset(sim_heatmap_t* heatmap);
+void heat_export(sim_heatmap_t* heatmap, FILE* out);
+
+int                  heat_region_count();
+const heat_region_t* heat_region(int region);
+const uint32_t*      heat_reads(sim_heatmap_t* heatmap, int region);
+const uint32_t*      heat_writes(sim_heatmap_t* heatmap, int region);
+
+void heat_draw(sim_heatmap_t* heatmap);
+
+#endif
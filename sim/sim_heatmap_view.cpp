@@ -0,0 +1,82 @@
+#include "imgui.h"
+#include <cmath>
+
+#include "sim_heatmap.h"
+
+typedef enum {
+    VIEW_READS,
+    VIEW_WRITES,
+    VIEW_TOTAL
+} heat_view_t;
+
+static ImU32 heat_color(float t)
+{
+    // black -> red -> yellow
+    if (t <= 0.0f)
+        return IM_COL32(24, 24, 24, 255);
+    if (t < 0.5f)
+        return IM_COL32((int)(255 * t * 2.0f), 0, 0, 255);
+    return IM_COL32(255, (int)(255 * (t - 0.5f) * 2.0f), 0, 255);
+}
+
+void heat_draw(sim_heatmap_t* heatmap)
+{
+    static int view = VIEW_TOTAL;
+
+    ImGui::Begin("Memory Heatmap");
+
+    ImGui::RadioButton("Reads", &view, VIEW_READS);
+    ImGui::SameLine();
+    ImGui::RadioButton("Writes", &view, VIEW_WRITES);
+    ImGui::SameLine();
+    ImGui::RadioButton("Total", &view, VIEW_TOTAL);
+    ImGui::SameLine();
+    if (ImGui::Button("Reset"))
+        heat_reset(heatmap);
+
+    const float cell = 6.0f;
+
+    for (int r=0; r<heat_region_count(); r++) {
+        const heat_region_t *region = heat_region(r);
+        const uint32_t      *reads  = heat_reads(heatmap, r);
+        const uint32_t      *writes = heat_writes(heatmap, r);
+
+        if (!ImGui::CollapsingHeader(region->name, ImGuiTreeNodeFlags_DefaultOpen))
+            continue;
+
+        // counts span several orders of magnitude, so scale logarithmically
+        uint32_t max = 0;
+        for (uint32_t i=0; i<region->words; i++) {
+            uint32_t count = (view == VIEW_READS) ? reads[i] : (view == VIEW_WRITES) ? writes[i] : reads[i] + writes[i];
+            if (count > max) max = count;
+        }
+        float scale = (max == 0) ? 0.0f : 1.0f / log2f((float)max + 1.0f);
+
+        uint32_t    rows = region->words / region->columns;
+        ImVec2      p    = ImGui::GetCursorScreenPos();
+        ImVec2      size = ImVec2(region->columns * cell, rows * cell);
+        ImDrawList* draw_list = ImGui::GetWindowDrawList();
+
+        ImGui::PushID(r);
+        ImGui::InvisibleButton("grid", size);
+        ImGui::PopID();
+
+        for (uint32_t i=0; i<region->words; i++) {
+            uint32_t count = (view == VIEW_READS) ? reads[i] : (view == VIEW_WRITES) ? writes[i] : reads[i] + writes[i];
+            float    x     = p.x + (i % region->columns) * cell;
+            float    y     = p.y + (i / region->columns) * cell;
+            draw_list->AddRectFilled(ImVec2(x, y), ImVec2(x + cell - 1.0f, y + cell - 1.0f), heat_color(log2f((float)count + 1.0f) * scale));
+        }
+
+        if (ImGui::IsItemHovered()) {
+            ImVec2   mouse = ImGui::GetIO().MousePos;
+            uint32_t col   = (uint32_t)((mouse.x - p.x) / cell);
+            uint32_t row   = (uint32_t)((mouse.y - p.y) / cell);
+            uint32_t i     = row * region->columns + col;
+            if (col < region->columns && row < rows)
+                ImGui::SetTooltip("%s 0x%08X (row %u, column %u)\nreads: %u\nwrites: %u", region->name, region->base + (i << 2), row, col, reads[i], writes[i]);
+        }
+    }
+
+    ImGui::End();
+}
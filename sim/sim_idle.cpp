@@ -0,0 +1,52 @@
+#include "sim_idle.h"
+#include "sim_probe.h"
+
+//
+// The core is asleep once it has been stalled on wfi, with no interrupt pending
+// and no input in flight to the board, for long enough that the pipeline and
+// store buffer have drained (and, for harnesses that draw the screen, the
+// framebuffer has been scanned out in full). From then on nothing on the board
+// can change until the harness applies new input, so the harness may stop
+// simulating until it does.
+//
+
+static const uint64_t SETTLE_CYCLES = 64;
+
+// vsync edges while sleeping before the framebuffer is known to be on screen
+// (the first edge only starts a frame)
+static uint32_t required_vsyncs(uint32_t frames) {
+    return frames ? frames + 1 : 0;
+}
+
+struct sim_idle {
+    uint32_t frames;    // full frames to scan out before sleeping
+    uint64_t cycles;    // cpu cycles spent sleeping
+    uint32_t vsyncs;    // vsync edges seen while sleeping
+    bool     vsync;     // last vsync level
+};
+
+sim_idle_t *idle_create(uint32_t frames) {
+    sim_idle_t *idle = new sim_idle_t {};
+    idle->frames = frames;
+    return idle;
+}
+
+void idle_destroy(sim_idle_t* idle) {
+    delete idle;
+}
+
+void idle_tick(sim_idle_t* idle, uint8_t stall, bool irq_pending, bool inputs_idle, bool vsync) {
+    if (stall != PROBE_STALL_WFI || irq_pending || !inputs_idle) {
+        idle->cycles = 0;
+        idle->vsyncs = 0;
+    } else {
+        idle->cycles++;
+        if (vsync && !idle->vsync && idle->vsyncs < required_vsyncs(idle->frames))
+            idle->vsyncs++;
+    }
+    idle->vsync = vsync;
+}
+
+bool idle_asleep(sim_idle_t* idle) {
+    return idle->cycles >= SETTLE_CYCLES && idle->vsyncs >= required_vsyncs(idle->frames);
+}
@@ -0,0 +1,14 @@
+#ifndef __SIM_IDLE_H
+#define __SIM_IDLE_H
+
+#include <cstdint>
+
+typedef struct sim_idle sim_idle_t;
+
+sim_idle_t *idle_create(uint32_t frames);
+void idle_destroy(sim_idle_t* idle);
+
+void idle_tick(sim_idle_t* idle, uint8_t stall, bool irq_pending, bool inputs_idle, bool vsync);
+bool idle_asleep(sim_idle_t* idle);
+
+#endif
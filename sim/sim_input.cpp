@@ -0,0 +1,206 @@
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <vector>
+
+#include "sim_input.h"
+
+//
+// Board inputs are recorded as one event per line, stamped with the simulation
+// tick (half cpu cycle) at which the event was applied to the model:
+//
+//   <cycle> make <glfw key>
+//   <cycle> break <glfw key>
+//   <cycle> switches <hex>
+//   <cycle> warp
+//   <cycle> end
+//
+// Replaying applies each event at its recorded tick and ignores live input, so
+// a replay runs the exact same simulation as the recorded session. A warp is the
+// harness jumping mtime to mtimecmp while the core slept, so it is input too.
+//
+
+typedef enum {
+    EVENT_MAKE,
+    EVENT_BREAK,
+    EVENT_SWITCHES,
+    EVENT_WARP,
+    EVENT_END
+} event_type_t;
+
+static const char* EVENT_NAMES[] = { "make", "break", "switches", "warp", "end" };
+
+typedef struct {
+    uint64_t     cycle;
+    event_type_t type;
+    uint32_t     value;
+} input_event_t;
+
+struct sim_input {
+    FILE*                      record;
+    bool                       replaying;
+    std::vector<input_event_t> replay;
+    size_t                     next;
+    uint64_t                   end;
+
+    // live key events, queued by the ui thread until the next tick
+    std::mutex                 lock;
+    std::vector<input_event_t> pending;
+    std::atomic<bool>          has_pending;
+
+    bool                       switches_valid;
+    uint16_t                   switches;
+    bool                       warp;
+};
+
+static void load(sim_input_t* input, FILE* in) {
+    char line[128];
+    while (fgets(line, sizeof(line), in)) {
+        unsigned long long cycle;
+        char               name[16];
+        unsigned int       value = 0;
+
+        if (line[0] == '#' || sscanf(line, "%llu %15s %x", &cycle, name, &value) < 2)
+            continue;
+
+        for (int type=EVENT_MAKE; type<=EVENT_END; type++) {
+            if (strcmp(name, EVENT_NAMES[type]) != 0)
+                continue;
+
+            // keys are recorded in decimal, switches in hex
+            if (type == EVENT_MAKE || type == EVENT_BREAK)
+                sscanf(line, "%*u %*s %u", &value);
+
+            input->replay.push_back({ cycle, (event_type_t)type, value });
+            if (type == EVENT_END)
+                input->end = cycle;
+        }
+    }
+}
+
+sim_input_t *input_create(const char* record_path, const char* replay_path) {
+    sim_input_t *input = new sim_input_t {};
+
+    if (replay_path && *replay_path) {
+        FILE *in = fopen(replay_path, "r");
+        if (in) {
+            load(input, in);
+            fclose(in);
+            input->replaying = true;
+        } else {
+            fprintf(stderr, "unable to open input replay: %s\n", replay_path);
+        }
+    }
+
+    if (record_path && *record_path) {
+        input->record = fopen(record_path, "w");
+        if (!input->record)
+            fprintf(stderr, "unable to open input recording: %s\n", record_path);
+    }
+
+    return input;
+}
+
+void input_destroy(sim_input_t* input, uint64_t cycle) {
+    if (input->record) {
+        fprintf(input->record, "%lu %s\n", cycle, EVENT_NAMES[EVENT_END]);
+        fclose(input->record);
+    }
+    delete input;
+}
+
+bool input_replaying(sim_input_t* input) {
+    return input->replaying;
+}
+
+uint64_t input_replay_end(sim_input_t* input) {
+    return input->end;
+}
+
+void input_key_make(sim_input_t* input, int key) {
+    std::lock_guard<std::mutex> guard(input->lock);
+    input->pending.push_back({ 0, EVENT_MAKE, (uint32_t)key });
+    input->has_pending = true;
+}
+
+void input_key_break(sim_input_t* input, int key) {
+    std::lock_guard<std::mutex> guard(input->lock);
+    input->pending.push_back({ 0, EVENT_BREAK, (uint32_t)key });
+    input->has_pending = true;
+}
+
+void input_timer_warp(sim_input_t* input) {
+    std::lock_guard<std::mutex> guard(input->lock);
+    input->pending.push_back({ 0, EVENT_WARP, 0 });
+    input->has_pending = true;
+}
+
+bool input_pending(sim_input_t* input) {
+    return input->has_pending;
+}
+
+static void apply(sim_input_t* input, uint64_t cycle, const input_event_t* event, sim_keyboard_t* keyboard) {
+    switch (event->type) {
+    case EVENT_MAKE:
+        key_make(keyboard, event->value);
+        break;
+    case EVENT_BREAK:
+        key_break(keyboard, event->value);
+        break;
+    case EVENT_SWITCHES:
+        input->switches       = event->value;
+        input->switches_valid = true;
+        break;
+    case EVENT_WARP:
+        input->warp = true;
+        break;
+    case EVENT_END:
+        return;
+    }
+
+    if (input->record) {
+        if (event->type == EVENT_SWITCHES)
+            fprintf(input->record, "%lu %s %04x\n", cycle, EVENT_NAMES[event->type], event->value);
+        else if (event->type == EVENT_WARP)
+            fprintf(input->record, "%lu %s\n", cycle, EVENT_NAMES[event->type]);
+        else
+            fprintf(input->record, "%lu %s %u\n", cycle, EVENT_NAMES[event->type], event->value);
+    }
+}
+
+void input_tick(sim_input_t* input, uint64_t cycle, sim_keyboard_t* keyboard, uint16_t* switches, bool* warp) {
+    *warp       = false;
+    input->warp = false;
+
+    if (input->replaying) {
+        // the recording owns the inputs, live events are dropped
+        while (input->next < input->replay.size() && input->replay[input->next].cycle <= cycle)
+            apply(input, cycle, &input->replay[input->next++], keyboard);
+        if (input->has_pending) {
+            std::lock_guard<std::mutex> guard(input->lock);
+            input->pending.clear();
+            input->has_pending = false;
+        }
+        if (input->switches_valid)
+            *switches = input->switches;
+        *warp = input->warp;
+        return;
+    }
+
+    // only take the lock when the ui thread has queued something
+    if (input->has_pending) {
+        std::lock_guard<std::mutex> guard(input->lock);
+        for (const input_event_t& event : input->pending)
+            apply(input, cycle, &event, keyboard);
+        input->pending.clear();
+        input->has_pending = false;
+    }
+    *warp = input->warp;
+
+    // switches are sampled every tick, so only changes are recorded
+    if (!input->switches_valid || *switches != input->switches) {
+        input_event_t event = { cycle, EVENT_SWITCHES, *switches };
+        apply(input, cycle, &event, keyboard);
+    }
+}
@@ -0,0 +1,22 @@
+#ifndef __SIM_INPUT_H
+#define __SIM_INPUT_H
+
+#include <cstdint>
+
+#include "sim_keyboard.h"
+
+typedef struct sim_input sim_input_t;
+
+sim_input_t *input_create(const char* record_path, const char* replay_path);
+void input_destroy(sim_input_t* input, uint64_t cycle);
+
+bool input_replaying(sim_input_t* input);
+uint64_t input_replay_end(sim_input_t* input);
+
+void input_key_make(sim_input_t* input, int key);
+void input_key_break(sim_input_t* input, int key);
+void input_timer_warp(sim_input_t* input);
+bool input_pending(sim_input_t* input);
+void input_tick(sim_input_t* input, uint64_t cycle, sim_keyboard_t* keyboard, uint16_t* switches, bool* warp);
+
+#endif
@@ -0,0 +1,160 @@
+#include "sim_irq_latency.h"
+#include "sim_probe.h"
+
+//
+// Interrupt latency is measured in cpu cycles across four milestones:
+//   ASSERT - the device raises its interrupt line
+//   MEIP   - the interrupt controller raises the cpu's external interrupt
+//   TRAP   - the first instruction of the trap handler (at mtvec) reaches decode
+//   READ   - the handler first reads one of the device's registers
+//
+
+static const int IRQ_SOURCES = 3;
+static const int HISTOGRAM_BUCKETS = 16;
+
+static const char*    SOURCE_NAMES[IRQ_SOURCES]       = { "uart",         "keyboard",         "switches"         };
+static const uint8_t  SOURCE_LINES[IRQ_SOURCES]       = { PROBE_IRQ_UART, PROBE_IRQ_KEYBOARD, PROBE_IRQ_SWITCHES };
+static const uint16_t SOURCE_CHIP_SELECT[IRQ_SOURCES] = { PROBE_CS_UART,  PROBE_CS_KEYBOARD,  PROBE_CS_SWITCHES  };
+
+typedef enum {
+    INTERVAL_ASSERT_MEIP,
+    INTERVAL_MEIP_TRAP,
+    INTERVAL_TRAP_READ,
+    INTERVAL_ASSERT_READ,
+    INTERVALS
+} interval_t;
+
+static const char* INTERVAL_NAMES[INTERVALS] = { "assert->meip", "meip->trap", "trap->read", "assert->read" };
+
+typedef enum {
+    IRQ_IDLE,       // line low
+    IRQ_ASSERTED,   // waiting for meip
+    IRQ_PENDING,    // waiting for the cpu to take the interrupt
+    IRQ_TAKEN,      // waiting for the handler to reach decode
+    IRQ_HANDLING,   // waiting for the handler to read the device
+    IRQ_DONE        // sample recorded, waiting for the line to drop
+} irq_state_t;
+
+typedef struct {
+    uint64_t count;
+    uint64_t min;
+    uint64_t max;
+    uint64_t total;
+    uint64_t histogram[HISTOGRAM_BUCKETS];
+} irq_stats_t;
+
+typedef struct {
+    irq_state_t state;
+    uint64_t    assert_cycle;
+    uint64_t    meip_cycle;
+    uint64_t    trap_cycle;
+    uint64_t    dropped;
+    irq_stats_t stats[INTERVALS];
+} irq_source_t;
+
+struct sim_irq_latency {
+    uint64_t     ncycles;
+    irq_source_t sources[IRQ_SOURCES];
+};
+
+sim_irq_latency_t *irqlat_create() {
+    return new sim_irq_latency_t {};
+}
+
+void irqlat_destroy(sim_irq_latency_t* irqlat) {
+    delete irqlat;
+}
+
+static int histogram_bucket(uint64_t cycles) {
+    // bucket 0 is [0, 1], bucket n is [2^n, 2^(n+1)), last bucket is open ended
+    int bucket = 0;
+    while (cycles > 1 && bucket < HISTOGRAM_BUCKETS-1) {
+        cycles >>= 1;
+        bucket++;
+    }
+    return bucket;
+}
+
+static void record(irq_stats_t* stats, uint64_t cycles) {
+    if (stats->count == 0 || cycles < stats->min) stats->min = cycles;
+    if (cycles > stats->max) stats->max = cycles;
+    stats->count++;
+    stats->total += cycles;
+    stats->histogram[histogram_bucket(cycles)]++;
+}
+
+void irqlat_tick(sim_irq_latency_t* irqlat, uint8_t sources, bool pending, bool taken, uint32_t decode_pc, bool read_enable, uint16_t chip_select) {
+    uint64_t now = irqlat->ncycles++;
+
+    for (int i=0; i<IRQ_SOURCES; i++) {
+        irq_source_t *src  = &irqlat->sources[i];
+        bool          line = (sources & SOURCE_LINES[i]) != 0;
+        bool          read = read_enable && (chip_select & SOURCE_CHIP_SELECT[i]) != 0;
+
+        if (src->state == IRQ_IDLE && line) {
+            src->state        = IRQ_ASSERTED;
+            src->assert_cycle = now;
+        }
+
+        if (src->state == IRQ_ASSERTED && pending) {
+            src->state      = IRQ_PENDING;
+            src->meip_cycle = now;
+        }
+
+        if (src->state == IRQ_PENDING && taken) {
+            src->state = IRQ_TAKEN;
+        } else if (src->state == IRQ_TAKEN && decode_pc != PROBE_NOP_PC) {
+            src->state      = IRQ_HANDLING;
+            src->trap_cycle = now;
+        } else if (src->state == IRQ_HANDLING && read) {
+            record(&src->stats[INTERVAL_ASSERT_MEIP], src->meip_cycle - src->assert_cycle);
+            record(&src->stats[INTERVAL_MEIP_TRAP],   src->trap_cycle - src->meip_cycle);
+            record(&src->stats[INTERVAL_TRAP_READ],   now - src->trap_cycle);
+            record(&src->stats[INTERVAL_ASSERT_READ], now - src->assert_cycle);
+            src->state = IRQ_DONE;
+        }
+
+        if (!line) {
+            // a line that drops before being serviced was polled, not interrupted
+            if (src->state != IRQ_IDLE && src->state != IRQ_DONE)
+                src->dropped++;
+            src->state = IRQ_IDLE;
+        }
+    }
+}
+
+void irqlat_report(sim_irq_latency_t* irqlat, FILE* out) {
+    fprintf(out, "Interrupt Latency (cpu cycles)\n");
+    fprintf(out, "%-10s %-14s %10s %10s %10s %10s\n", "source", "interval", "count", "min", "avg", "max");
+
+    for (int i=0; i<IRQ_SOURCES; i++) {
+        irq_source_t *src = &irqlat->sources[i];
+        for (int j=0; j<INTERVALS; j++) {
+            irq_stats_t *stats = &src->stats[j];
+            double avg = stats->count ? ((double)stats->total / stats->count) : 0.0;
+            fprintf(out, "%-10s %-14s %10lu %10lu %10.1f %10lu\n", SOURCE_NAMES[i], INTERVAL_NAMES[j], stats->count, stats->min, avg, stats->max);
+        }
+        if (src->dropped)
+            fprintf(out, "%-10s %-14s %10lu\n", SOURCE_NAMES[i], "unserviced", src->dropped);
+    }
+
+    for (int i=0; i<IRQ_SOURCES; i++) {
+        irq_stats_t *stats = &irqlat->sources[i].stats[INTERVAL_ASSERT_READ];
+        if (stats->count == 0)
+            continue;
+
+        fprintf(out, "\nHistogram: %s %s\n", SOURCE_NAMES[i], INTERVAL_NAMES[INTERVAL_ASSERT_READ]);
+        for (int b=0; b<HISTOGRAM_BUCKETS; b++) {
+            if (stats->histogram[b] == 0)
+                continue;
+
+            uint64_t lo = (b == 0) ? 0 : (1ull << b);
+            uint64_t hi = (1ull << (b+1)) - 1;
+            int      bar = (int)((stats->histogram[b] * 50) / stats->count);
+            if (b == HISTOGRAM_BUCKETS-1)
+                fprintf(out, "  [%6lu,    inf] %8lu %.*s\n", lo, stats->histogram[b], bar, "##################################################");
+            else
+                fprintf(out, "  [%6lu, %6lu] %8lu %.*s\n", lo, hi, stats->histogram[b], bar, "##################################################");
+        }
+    }
+}
@@ -0,0 +1,15 @@
+#ifndef __SIM_IRQ_LATENCY_H
+#define __SIM_IRQ_LATENCY_H
+
+#include <cstdint>
+#include <cstdio>
+
+typedef struct sim_irq_latency sim_irq_latency_t;
+
+sim_irq_latency_t *irqlat_create();
+void irqlat_destroy(sim_irq_latency_t* irqlat);
+
+void irqlat_tick(sim_irq_latency_t* irqlat, uint8_t sources, bool pending, bool taken, uint32_t decode_pc, bool read_enable, uint16_t chip_select);
+void irqlat_report(sim_irq_latency_t* irqlat, FILE* out);
+
+#endif
@@ -67,6 +67,11 @@ void key_tick(sim_keyboard_t* keyboard, unsigned char *ps2_clk, unsigned char *p
     }
 }
 
+bool key_idle(sim_keyboard_t* keyboard) {
+    // nothing queued and nothing being clocked out
+    return keyboard->keys.empty() && keyboard->current_bit == 0xFF;
+}
+
 uint16_t key_to_scancode(int key) {
     switch (key) {
         case GLFW_KEY_A:             return 0x001C;
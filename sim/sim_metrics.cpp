@@ -0,0 +1,124 @@
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <sys/resource.h>
+#include <sys/stat.h>
+
+#include "sim_metrics.h"
+#include "sim_probe.h"
+
+//
+// Metrics are written as JSON lines, one snapshot per line, every `period` cpu cycles
+// and once more at exit (with "final": true).  The keys and their order are part of
+// the schema; bump METRICS_SCHEMA when changing either so runs stay comparable.
+// Hardware performance counter events are listed under "events" in bit order; new
+// events only add keys there, so they don't need a schema bump.
+//
+
+static const int      METRICS_SCHEMA = 3;
+static const uint64_t DEFAULT_PERIOD = 1000000;
+
+struct sim_metrics {
+    FILE*       out;
+    std::string tool;
+    std::string trace_path;
+    uint64_t    period;
+
+    std::chrono::steady_clock::time_point start;
+
+    uint64_t ncycles;
+    uint64_t instret;
+    uint64_t stall_data;
+    uint64_t stall_csr;
+    uint64_t stall_wfi;
+    uint64_t stall_memory;
+    uint64_t bubbles;
+    uint64_t frames;
+    bool     last_vsync;
+    uint64_t events[PROBE_EVENTS];
+};
+
+static void metrics_write(sim_metrics_t* metrics, bool final) {
+    if (!metrics->out)
+        return;
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - metrics->start).count();
+    double mhz     = seconds > 0.0 ? (metrics->ncycles / seconds / 1000000.0) : 0.0;
+    double ipc     = metrics->ncycles ? ((double)metrics->instret / metrics->ncycles) : 0.0;
+
+    // ru_maxrss is in kilobytes on linux
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+
+    struct stat trace;
+    uint64_t trace_bytes = 0;
+    if (!metrics->trace_path.empty() && stat(metrics->trace_path.c_str(), &trace) == 0)
+        trace_bytes = trace.st_size;
+
+    fprintf(metrics->out,
+        "{ \"schema\": %d, \"tool\": \"%s\", \"final\": %s, "
+        "\"host_seconds\": %.3f, \"sim_cycles\": %lu, \"sim_mhz\": %.3f, "
+        "\"instret\": %lu, \"ipc\": %.4f, "
+        "\"stalls\": { \"data\": %lu, \"csr\": %lu, \"wfi\": %lu, \"memory\": %lu, \"bubble\": %lu }, "
+        "\"frames\": %lu, \"peak_rss_kb\": %ld, \"trace_bytes\": %lu, \"events\": { ",
+        METRICS_SCHEMA, metrics->tool.c_str(), final ? "true" : "false",
+        seconds, metrics->ncycles, mhz,
+        metrics->instret, ipc,
+        metrics->stall_data, metrics->stall_csr, metrics->stall_wfi, metrics->stall_memory, metrics->bubbles,
+        metrics->frames, usage.ru_maxrss, trace_bytes);
+    for (int i=0; i<PROBE_EVENTS; i++)
+        fprintf(metrics->out, "%s\"%s\": %lu", i ? ", " : "", PROBE_EVENT_NAMES[i], metrics->events[i]);
+    fprintf(metrics->out, " } }\n");
+    fflush(metrics->out);
+}
+
+sim_metrics_t *metrics_create(const char* path, const char* tool, const char* trace_path, uint64_t period) {
+    sim_metrics_t *metrics = new sim_metrics_t {};
+    metrics->out        = (path && *path) ? fopen(path, "w") : NULL;
+    metrics->tool       = tool;
+    metrics->trace_path = trace_path ? trace_path : "";
+    metrics->period     = period ? period : DEFAULT_PERIOD;
+    metrics->start      = std::chrono::steady_clock::now();
+    return metrics;
+}
+
+void metrics_destroy(sim_metrics_t* metrics) {
+    metrics_write(metrics, true);
+    if (metrics->out)
+        fclose(metrics->out);
+    delete metrics;
+}
+
+void metrics_tick(sim_metrics_t* metrics, uint32_t decode_pc, uint8_t stall, uint32_t retire_pc, uint32_t events, bool vsync) {
+    metrics->ncycles++;
+
+    if (retire_pc != PROBE_NOP_PC)
+        metrics->instret++;
+
+    // a pair retires as one operation, count its second instruction as it issues (like minstret)
+    metrics->instret += __builtin_popcount(events & PROBE_PAIR_EVENTS);
+
+    // decode is either empty, stalled, or accepting an instruction
+    if (decode_pc == PROBE_NOP_PC)
+        metrics->bubbles++;
+    else if (stall == PROBE_STALL_DATA)
+        metrics->stall_data++;
+    else if (stall == PROBE_STALL_CSR)
+        metrics->stall_csr++;
+    else if (stall == PROBE_STALL_WFI)
+        metrics->stall_wfi++;
+    else if (stall == PROBE_STALL_MEMORY)
+        metrics->stall_memory++;
+
+    for (int i=0; events; i++, events >>= 1)
+        if (events & 1)
+            metrics->events[i]++;
+
+    // vsync is active low, a frame ends on its falling edge
+    if (metrics->last_vsync && !vsync)
+        metrics->frames++;
+    metrics->last_vsync = vsync;
+
+    if (metrics->ncycles % metrics->period == 0)
+        metrics_write(metrics, false);
+}
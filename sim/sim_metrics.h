@@ -0,0 +1,13 @@
+#ifndef __SIM_METRICS_H
+#define __SIM_METRICS_H
+
+#include <cstdint>
+
+typedef struct sim_metrics sim_metrics_t;
+
+sim_metrics_t *metrics_create(const char* path, const char* tool, const char* trace_path, uint64_t period);
+void metrics_destroy(sim_metrics_t* metrics);
+
+void metrics_tick(sim_metrics_t* metrics, uint32_t decode_pc, uint8_t stall, uint32_t retire_pc, uint32_t events, bool vsync);
+
+#endif
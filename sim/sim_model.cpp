@@ -7,13 +7,22 @@
 #include <GL/gl3w.h>
 #include <GLFW/glfw3.h>
 #include <cstdint>
+#include <cstdlib>
+#include <string>
 #include <thread>
+#include <chrono>
 
 #include "verilator/Vtop.h"
 #include "sim_vga.h"
 #include "sim_segdisplay.h"
 #include "sim_switch.h"
 #include "sim_keyboard.h"
+#include "sim_irq_latency.h"
+#include "sim_heatmap.h"
+#include "sim_profile.h"
+#include "sim_metrics.h"
+#include "sim_input.h"
+#include "sim_idle.h"
 #include "sim_model.h"
 
 struct sim_model {
@@ -27,8 +36,28 @@ struct sim_model {
     uint64_t        ncycles;
     sim_keyboard_t *keyboard;
     sim_vga_t      *vga;
+    sim_input_t    *input;
+    sim_idle_t     *idle;
+    bool            sleeping;
+    std::chrono::steady_clock::time_point sleep_start;
+
+    sim_irq_latency_t *irq_latency;
+    std::string        irq_latency_path;
+    sim_heatmap_t     *heatmap;
+    std::string        heatmap_path;
+    sim_profile_t     *profile;
+    std::string        profile_path;
+    std::string        profile_dis_path;
+    sim_metrics_t     *metrics;
 };
 
+static std::string plusarg(const char *name) {
+    // verilator returns the whole "+name=value" argument, or "" if absent
+    std::string prefix = std::string(name) + "=";
+    std::string match  = Verilated::commandArgsPlusMatch(prefix.c_str());
+    return match.empty() ? "" : match.substr(prefix.size() + 1);
+}
+
 sim_model_t* sim_create(int argc, char **argv) {
     // Init Verilator
     Verilated::commandArgs(argc, argv);
@@ -36,6 +65,20 @@ sim_model_t* sim_create(int argc, char **argv) {
     sim_model_t *model = new sim_model_t();
     model->vga         = vga_create();
     model->keyboard    = key_create();
+    model->input       = input_create(plusarg("record_input").c_str(), plusarg("replay_input").c_str());
+    model->idle        = idle_create(1);
+
+    // Instrumentation
+    model->irq_latency      = irqlat_create();
+    model->irq_latency_path = plusarg("irq_latency");
+    model->heatmap          = heat_create(atoi(plusarg("heatmap_sample").c_str()));
+    model->heatmap_path     = plusarg("heatmap");
+    model->profile          = prof_create();
+    model->profile_path     = plusarg("profile");
+    model->profile_dis_path = plusarg("profile_dis");
+    if (model->profile_dis_path.empty())
+        model->profile_dis_path = "../roms/bios/bios.dis";
+    model->metrics          = metrics_create(plusarg("metrics").c_str(), "sim", NULL, strtoull(plusarg("metrics_period").c_str(), NULL, 10));
     for (int i=4; i<16; i++)
         model->switches[i] = true;
 
@@ -60,8 +103,37 @@ void sim_destroy(sim_model_t* model) {
     model->thread_exit = true;
     model->tick_thread.join();
 
+    // Report Instrumentation
+    if (!model->irq_latency_path.empty()) {
+        FILE *out = fopen(model->irq_latency_path.c_str(), "w");
+        if (out) {
+            irqlat_report(model->irq_latency, out);
+            fclose(out);
+        }
+    }
+    if (!model->heatmap_path.empty()) {
+        FILE *out = fopen(model->heatmap_path.c_str(), "w");
+        if (out) {
+            heat_export(model->heatmap, out);
+            fclose(out);
+        }
+    }
+    if (!model->profile_path.empty()) {
+        FILE *out = fopen(model->profile_path.c_str(), "w");
+        if (out) {
+            prof_report(model->profile, out, model->profile_dis_path.c_str());
+            fclose(out);
+        }
+    }
+
     // Cleanup Components
+    input_destroy(model->input, model->ncycles);
     key_destroy(model->keyboard);
+    idle_destroy(model->idle);
+    irqlat_destroy(model->irq_latency);
+    heat_destroy(model->heatmap);
+    prof_destroy(model->profile);
+    metrics_destroy(model->metrics);
 
     // Cleanup DUT
     model->top->final();
@@ -73,9 +145,49 @@ void sim_destroy(sim_model_t* model) {
 void sim_tick(sim_model_t* model) {
     Vtop *dut = model->top;
 
+    // update switches
+    uint16_t switch_i = 0;
+    for (int i=0; i<16; i++)
+        switch_i |= model->switches[15-i] << i;
+
+    // while the core sleeps and no input is waiting, nothing can change before the
+    // next timer deadline, so stop simulating until input arrives or the wall clock
+    // reaches the deadline, then jump mtime straight to it (replays run every tick
+    // to stay exact, and recordings made here stamp the waking input, or the warp,
+    // at the tick simulation stopped)
+    if (idle_asleep(model->idle) && !input_replaying(model->input) && !input_pending(model->input) && key_idle(model->keyboard) && switch_i == dut->switch_i && !dut->probe_timer_warp_i) {
+        auto now = std::chrono::steady_clock::now();
+        if (!model->sleeping) {
+            model->sleeping    = true;
+            model->sleep_start = now;
+        }
+
+        uint64_t mtime    = dut->probe_mtime_o;
+        uint64_t mtimecmp = dut->probe_mtimecmp_o;
+        bool     armed    = mtimecmp > mtime && mtimecmp != UINT64_MAX;
+        if (!armed || now - model->sleep_start < std::chrono::duration<double>((mtimecmp - mtime) / 50000000.0)) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            return;
+        }
+        input_timer_warp(model->input);
+    }
+    model->sleeping = false;
+
     // update top
     dut->eval();
 
+    // sample probes once per cpu cycle, just after the rising edge
+    if (dut->cpu_clk_i) {
+        irqlat_tick(model->irq_latency, dut->probe_irq_source_o, dut->probe_irq_pending_o, dut->probe_irq_taken_o, dut->probe_decode_pc_o, dut->probe_bus_read_enable_o, dut->probe_bus_chip_select_o);
+        heat_tick(model->heatmap, dut->probe_bus_addr_o, dut->probe_bus_read_enable_o, dut->probe_bus_write_mask_o, dut->probe_bus_chip_select_o);
+        prof_tick(model->profile, dut->probe_decode_pc_o, dut->probe_decode_pc2_o, dut->probe_decode_ready_o, dut->probe_jump_o, dut->probe_retire_pc_o, dut->probe_events_o);
+        metrics_tick(model->metrics, dut->probe_decode_pc_o, dut->probe_stall_o, dut->probe_retire_pc_o, dut->probe_events_o, dut->vga_vsync_o);
+        idle_tick(model->idle, dut->probe_stall_o, dut->probe_irq_pending_o || dut->probe_mtime_o >= dut->probe_mtimecmp_o, key_idle(model->keyboard), dut->vga_vsync_o);
+
+        // a warp is taken on the rising edge
+        dut->probe_timer_warp_i = 0;
+    }
+
     // next cycle
     model->ncycles++;
 
@@ -83,10 +195,14 @@ void sim_tick(sim_model_t* model) {
     dut->cpu_clk_i ^= 1;
     if (model->ncycles % 3 == 0) { dut->pxl_clk_i ^= 1; }
 
-    // update switches
-    uint16_t switch_i = 0;
-    for (int i=0; i<16; i++)
-        switch_i |= model->switches[15-i] << i;
+    // apply (and record) live input, or replay recorded input
+    bool warp;
+    input_tick(model->input, model->ncycles, model->keyboard, &switch_i, &warp);
+    if (warp)
+        dut->probe_timer_warp_i = 1;
+    if (input_replaying(model->input))
+        for (int i=0; i<16; i++)
+            model->switches[15-i] = (switch_i >> i) & 1;
     dut->switch_i = switch_i;
 
     // update seven segment display
@@ -131,12 +247,14 @@ void sim_draw(sim_model_t* model, float secondsElapsed) {
     float rate = (mhz * 100.0f) / 50.0f;
 
     ImGui::Text("Simulation Speed: %3.03fMHz (%2.0f%%)", mhz, rate);
+
+    heat_draw(model->heatmap);
 }
 
 void sim_on_key_make(sim_model_t* model, int key) {
-    key_make(model->keyboard, key);
+    input_key_make(model->input, key);
 }
 
 void sim_on_key_break(sim_model_t* model, int key) {
-    key_break(model->keyboard, key);
+    input_key_break(model->input, key);
 }
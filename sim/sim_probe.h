@@ -0,0 +1,54 @@
+#ifndef __SIM_PROBE_H
+#define __SIM_PROBE_H
+
+#include <cstdint>
+
+// Program counter of an empty pipeline slot (see NOP_PC in cpu_common.sv)
+static const uint32_t PROBE_NOP_PC = 0xFFFFFFFF;
+
+// Chip select bits (see chip_select_t in common.sv)
+static const uint16_t PROBE_CS_VGA      = 1 << 0;
+static const uint16_t PROBE_CS_IRQ      = 1 << 1;
+static const uint16_t PROBE_CS_UART     = 1 << 2;
+static const uint16_t PROBE_CS_SWITCHES = 1 << 3;
+static const uint16_t PROBE_CS_DISPLAY  = 1 << 4;
+static const uint16_t PROBE_CS_KEYBOARD = 1 << 5;
+static const uint16_t PROBE_CS_VRAM     = 1 << 6;
+static const uint16_t PROBE_CS_RAM      = 1 << 7;
+static const uint16_t PROBE_CS_BIOS     = 1 << 8;
+static const uint16_t PROBE_CS_TIMER    = 1 << 9;
+
+// Interrupt source bits (see interrupt_t in roms/bios/peripherals/interrupt.h)
+static const uint8_t  PROBE_IRQ_UART     = 1 << 0;
+static const uint8_t  PROBE_IRQ_KEYBOARD = 1 << 1;
+static const uint8_t  PROBE_IRQ_SWITCHES = 1 << 2;
+
+// Decode stall causes (see stall_t in cpu_common.sv)
+static const uint8_t  PROBE_STALL_NONE   = 0;
+static const uint8_t  PROBE_STALL_DATA   = 1;
+static const uint8_t  PROBE_STALL_CSR    = 2;
+static const uint8_t  PROBE_STALL_WFI    = 3;
+static const uint8_t  PROBE_STALL_MEMORY = 4;
+
+// Performance counter events, in bit order (see HPM_* in cpu_common.sv)
+static const char* PROBE_EVENT_NAMES[] = {
+    "branch_hit",
+    "branch_miss",
+    "return_hit",
+    "return_miss",
+    "icache_hit",
+    "icache_miss",
+    "dcache_hit",
+    "dcache_miss",
+    "dcache_writeback",
+    "fuse_lui_addi",
+    "fuse_auipc_jalr",
+    "fuse_slli_srli",
+    "dual_issue",
+};
+static const int   PROBE_EVENTS = sizeof(PROBE_EVENT_NAMES) / sizeof(PROBE_EVENT_NAMES[0]);
+
+// Events that issue a second instruction with the first, which then retire as one (fused and dual issue)
+static const uint32_t PROBE_PAIR_EVENTS = 0xF << 9;
+
+#endif
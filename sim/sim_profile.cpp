@@ -0,0 +1,184 @@
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "sim_profile.h"
+#include "sim_probe.h"
+
+//
+// Every cpu cycle is charged to exactly one bucket:
+//   DECODE  - the cycle an instruction spends in decode, split into stalled and accepted cycles
+//   PENALTY - a bubble behind a taken jump/branch, charged to the instruction that redirected fetch
+//   IDLE    - any other empty decode slot (reset, fetch refill)
+//
+
+static const size_t HOT_SPOTS = 40;
+
+typedef struct {
+    uint64_t cycles;   // cycles in decode, including stalls
+    uint64_t stalls;   // cycles in decode while not ready
+    uint64_t penalty;  // bubbles following a jump taken by this instruction
+    uint64_t retired;  // times retired
+} prof_entry_t;
+
+struct sim_profile {
+    uint64_t ncycles;
+    uint64_t idle;
+    uint32_t last_pc;      // last instruction accepted by decode
+    uint32_t last_pc2;     // second instruction of a pair accepted with it
+    uint32_t redirect_pc;  // instruction responsible for the current bubbles
+    std::unordered_map<uint32_t, prof_entry_t> entries;
+};
+
+sim_profile_t *prof_create() {
+    sim_profile_t *profile = new sim_profile_t {};
+    profile->last_pc     = PROBE_NOP_PC;
+    profile->last_pc2    = PROBE_NOP_PC;
+    profile->redirect_pc = PROBE_NOP_PC;
+    return profile;
+}
+
+void prof_destroy(sim_profile_t* profile) {
+    delete profile;
+}
+
+void prof_tick(sim_profile_t* profile, uint32_t decode_pc, uint32_t decode_pc2, bool decode_ready, bool jump, uint32_t retire_pc, uint32_t events) {
+    profile->ncycles++;
+
+    // a jump is visible the cycle after its instruction was accepted by decode
+    if (jump)
+        profile->redirect_pc = profile->last_pc;
+
+    // a pair retires as one operation, so its second instruction is credited as it issues (like minstret),
+    // which its event reports the cycle after the pair was accepted
+    if ((events & PROBE_PAIR_EVENTS) && profile->last_pc2 != PROBE_NOP_PC)
+        profile->entries[profile->last_pc2].retired++;
+
+    if (decode_pc != PROBE_NOP_PC) {
+        prof_entry_t *entry = &profile->entries[decode_pc];
+        entry->cycles++;
+        if (decode_ready) {
+            profile->last_pc  = decode_pc;
+            profile->last_pc2 = decode_pc2;
+        } else {
+            entry->stalls++;
+        }
+        profile->redirect_pc = PROBE_NOP_PC;
+    } else if (profile->redirect_pc != PROBE_NOP_PC) {
+        profile->entries[profile->redirect_pc].penalty++;
+    } else {
+        profile->idle++;
+    }
+
+    if (retire_pc != PROBE_NOP_PC)
+        profile->entries[retire_pc].retired++;
+}
+
+static bool parse_address(const std::string& line, uint32_t* addr, size_t* text) {
+    // instruction lines look like "     1c4:\t00c12083          \tlw\tra,12(sp)"
+    if (line.empty() || !isspace((unsigned char)line[0]))
+        return false;
+
+    char *end;
+    const char *start = line.c_str();
+    while (isspace((unsigned char)*start)) start++;
+    unsigned long value = strtoul(start, &end, 16);
+    if (end == start || *end != ':')
+        return false;
+
+    *addr = (uint32_t)value;
+    *text = (end + 1) - line.c_str();
+    return true;
+}
+
+static void print_counts(FILE* out, const prof_entry_t* entry, uint64_t ncycles) {
+    uint64_t total = entry->cycles + entry->penalty;
+    double   pct   = ncycles ? (100.0 * total / ncycles) : 0.0;
+    double   cpi   = entry->retired ? ((double)total / entry->retired) : 0.0;
+    fprintf(out, "%10lu %6.2f%% %10lu %10lu %10lu %6.2f", total, pct, entry->stalls, entry->penalty, entry->retired, cpi);
+}
+
+void prof_report(sim_profile_t* profile, FILE* out, const char* disassembly_path) {
+    // load the listing, remembering the text of each instruction
+    std::vector<std::string> listing;
+    std::unordered_map<uint32_t, std::string> text;
+    FILE *dis = disassembly_path ? fopen(disassembly_path, "r") : NULL;
+    if (dis) {
+        char buffer[1024];
+        while (fgets(buffer, sizeof(buffer), dis)) {
+            std::string line(buffer);
+            if (!line.empty() && line.back() == '\n')
+                line.pop_back();
+
+            uint32_t addr;
+            size_t   offset;
+            if (parse_address(line, &addr, &offset)) {
+                std::string instruction = line.substr(offset);
+                std::replace(instruction.begin(), instruction.end(), '\t', ' ');
+                instruction.erase(std::unique(instruction.begin(), instruction.end(), [](char a, char b) { return a == ' ' && b == ' '; }), instruction.end());
+                text[addr] = instruction.substr(instruction.find_first_not_of(' ') == std::string::npos ? 0 : instruction.find_first_not_of(' '));
+            }
+            listing.push_back(line);
+        }
+        fclose(dis);
+    }
+
+    prof_entry_t totals {};
+    for (auto& [pc, entry] : profile->entries) {
+        totals.cycles  += entry.cycles;
+        totals.stalls  += entry.stalls;
+        totals.penalty += entry.penalty;
+        totals.retired += entry.retired;
+    }
+
+    fprintf(out, "Per-PC Cycle Accounting (cpu cycles)\n");
+    fprintf(out, "%-10s %10lu\n", "cycles",  profile->ncycles);
+    fprintf(out, "%-10s %10lu\n", "decode",  totals.cycles);
+    fprintf(out, "%-10s %10lu\n", "stalls",  totals.stalls);
+    fprintf(out, "%-10s %10lu\n", "penalty", totals.penalty);
+    fprintf(out, "%-10s %10lu\n", "idle",    profile->idle);
+    fprintf(out, "%-10s %10lu\n", "retired", totals.retired);
+
+    // hot spots, by cycles charged
+    std::vector<uint32_t> pcs;
+    for (auto& [pc, entry] : profile->entries)
+        pcs.push_back(pc);
+    std::sort(pcs.begin(), pcs.end(), [profile](uint32_t a, uint32_t b) {
+        const prof_entry_t& ea = profile->entries[a];
+        const prof_entry_t& eb = profile->entries[b];
+        uint64_t ta = ea.cycles + ea.penalty;
+        uint64_t tb = eb.cycles + eb.penalty;
+        return (ta != tb) ? (ta > tb) : (a < b);
+    });
+
+    fprintf(out, "\nHot Spots\n");
+    fprintf(out, "%10s %7s %10s %10s %10s %6s  %-8s  %s\n", "cycles", "%", "stalls", "penalty", "retired", "cpi", "pc", "instruction");
+    for (size_t i=0; i<pcs.size() && i<HOT_SPOTS; i++) {
+        auto found = text.find(pcs[i]);
+        print_counts(out, &profile->entries[pcs[i]], profile->ncycles);
+        fprintf(out, "  %08x  %s\n", pcs[i], (found == text.end()) ? "?" : found->second.c_str());
+    }
+
+    if (listing.empty())
+        return;
+
+    // the full listing, annotated
+    fprintf(out, "\nAnnotated Listing (%s)\n", disassembly_path);
+    fprintf(out, "%10s %7s %10s %10s %10s %6s\n", "cycles", "%", "stalls", "penalty", "retired", "cpi");
+    for (const std::string& line : listing) {
+        uint32_t addr;
+        size_t   offset;
+        auto     found = profile->entries.end();
+        if (parse_address(line, &addr, &offset))
+            found = profile->entries.find(addr);
+
+        if (found != profile->entries.end())
+            print_counts(out, &found->second, profile->ncycles);
+        else
+            fprintf(out, "%58s", "");
+        fprintf(out, " | %s\n", line.c_str());
+    }
+}
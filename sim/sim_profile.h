@@ -0,0 +1,15 @@
+#ifndef __SIM_PROFILE_H
+#define __SIM_PROFILE_H
+
+#include <cstdint>
+#include <cstdio>
+
+typedef struct sim_profile sim_profile_t;
+
+sim_profile_t *prof_create();
+void prof_destroy(sim_profile_t* profile);
+
+void prof_tick(sim_profile_t* profile, uint32_t decode_pc, uint32_t decode_pc2, bool decode_ready, bool jump, uint32_t retire_pc, uint32_t events);
+void prof_report(sim_profile_t* profile, FILE* out, const char* disassembly_path);
+
+#endif
@@ -14,6 +14,7 @@ typedef logic [63:0] dword_t;
 
 // Data Bus Chip Select
 typedef struct packed {
+    logic timer;
     logic bios;
     logic ram;
     logic vram;
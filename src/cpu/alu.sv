@@ -3,6 +3,10 @@
 ///
 /// I32 ALU (async)
 ///
+/// Specs:
+/// Base integer operations, plus the Zba, Zbb and Zbs bit manipulation extensions
+/// Multiply/divide results come from the muldiv unit instead
+///
 
 module alu
     // Import Constants
@@ -21,23 +25,77 @@ module alu
 
 // Shift Amount
 logic [4:0] shamt;
-always_comb shamt = alu_op2_i[4:0];
+logic [4:0] shamt2;
+always_comb shamt  = alu_op2_i[4:0];
+always_comb shamt2 = alu_op2_i[9:5];
+
+// Single Bit (Zbs)
+word_t bit_mask;
+always_comb bit_mask = 32'b1 << shamt;
+
+// Bit Counts (Zbb)
+word_t leading_zeros;
+word_t trailing_zeros;
+word_t population;
+always_comb begin
+    leading_zeros  = 32'd32;
+    trailing_zeros = 32'd32;
+    population     = 32'd0;
+    for (int i=0; i<32; i++) begin
+        if (alu_op1_i[i])      leading_zeros  = 32'(31 - i);  // ends at the highest set bit
+        if (alu_op1_i[31 - i]) trailing_zeros = 32'(31 - i);  // ends at the lowest set bit
+        population = population + 32'(alu_op1_i[i]);
+    end
+end
+
+// OR-Combine Bytes (Zbb)
+word_t or_combined;
+always_comb begin
+    for (int b=0; b<4; b++)
+        or_combined[b*8 +: 8] = (alu_op1_i[b*8 +: 8] != 8'b0) ? 8'hFF : 8'h00;
+end
 
 // Result Logic
 always_comb begin
     unique case (alu_mode_i)
-        ALU_ADD:   alu_result_async_o = alu_op1_i + alu_op2_i;
-        ALU_SUB:   alu_result_async_o = alu_op1_i - alu_op2_i;
-        ALU_AND:   alu_result_async_o = alu_op1_i & alu_op2_i;
-        ALU_OR:    alu_result_async_o = alu_op1_i | alu_op2_i;
-        ALU_XOR:   alu_result_async_o = alu_op1_i ^ alu_op2_i;
-        ALU_LSL:   alu_result_async_o = alu_op1_i <<  shamt;
-        ALU_LSR:   alu_result_async_o = alu_op1_i >>  shamt;
-        ALU_ASR:   alu_result_async_o = alu_op1_i >>> shamt;
-        ALU_SLT:   alu_result_async_o = (signed'(alu_op1_i) < signed'(alu_op2_i)) ? 32'b1 : 32'b0;
-        ALU_ULT:   alu_result_async_o = (        alu_op1_i  <         alu_op2_i)  ? 32'b1 : 32'b0;
-        ALU_COPY1: alu_result_async_o = alu_op1_i;
-        ALU_X:     alu_result_async_o = 32'b0;
+        ALU_ADD:     alu_result_async_o = alu_op1_i + alu_op2_i;
+        ALU_SUB:     alu_result_async_o = alu_op1_i - alu_op2_i;
+        ALU_AND:     alu_result_async_o = alu_op1_i & alu_op2_i;
+        ALU_OR:      alu_result_async_o = alu_op1_i | alu_op2_i;
+        ALU_XOR:     alu_result_async_o = alu_op1_i ^ alu_op2_i;
+        ALU_LSL:     alu_result_async_o = alu_op1_i <<  shamt;
+        ALU_LSR:     alu_result_async_o = alu_op1_i >>  shamt;
+        ALU_ASR:     alu_result_async_o = alu_op1_i >>> shamt;
+        ALU_LSL_LSR: alu_result_async_o = (alu_op1_i << shamt) >> shamt2;  // fused slli+srli
+        ALU_SLT:     alu_result_async_o = (signed'(alu_op1_i) < signed'(alu_op2_i)) ? 32'b1 : 32'b0;
+        ALU_ULT:     alu_result_async_o = (        alu_op1_i  <         alu_op2_i)  ? 32'b1 : 32'b0;
+        ALU_COPY1:   alu_result_async_o = alu_op1_i;
+        ALU_SH1ADD:  alu_result_async_o = (alu_op1_i << 1) + alu_op2_i;
+        ALU_SH2ADD:  alu_result_async_o = (alu_op1_i << 2) + alu_op2_i;
+        ALU_SH3ADD:  alu_result_async_o = (alu_op1_i << 3) + alu_op2_i;
+        ALU_ANDN:    alu_result_async_o = alu_op1_i & ~alu_op2_i;
+        ALU_ORN:     alu_result_async_o = alu_op1_i | ~alu_op2_i;
+        ALU_XNOR:    alu_result_async_o = alu_op1_i ^ ~alu_op2_i;
+        ALU_CLZ:     alu_result_async_o = leading_zeros;
+        ALU_CTZ:     alu_result_async_o = trailing_zeros;
+        ALU_CPOP:    alu_result_async_o = population;
+        ALU_MIN:     alu_result_async_o = (signed'(alu_op1_i) < signed'(alu_op2_i)) ? alu_op1_i : alu_op2_i;
+        ALU_MINU:    alu_result_async_o = (        alu_op1_i  <         alu_op2_i)  ? alu_op1_i : alu_op2_i;
+        ALU_MAX:     alu_result_async_o = (signed'(alu_op1_i) < signed'(alu_op2_i)) ? alu_op2_i : alu_op1_i;
+        ALU_MAXU:    alu_result_async_o = (        alu_op1_i  <         alu_op2_i)  ? alu_op2_i : alu_op1_i;
+        ALU_SEXTB:   alu_result_async_o = { {24{alu_op1_i[ 7]}}, alu_op1_i[ 7:0] };
+        ALU_SEXTH:   alu_result_async_o = { {16{alu_op1_i[15]}}, alu_op1_i[15:0] };
+        ALU_ZEXTH:   alu_result_async_o = { 16'b0,               alu_op1_i[15:0] };
+        ALU_ROL:     alu_result_async_o = (alu_op1_i << shamt) | (alu_op1_i >> (6'd32 - 6'(shamt)));
+        ALU_ROR:     alu_result_async_o = (alu_op1_i >> shamt) | (alu_op1_i << (6'd32 - 6'(shamt)));
+        ALU_ORCB:    alu_result_async_o = or_combined;
+        ALU_REV8:    alu_result_async_o = { alu_op1_i[7:0], alu_op1_i[15:8], alu_op1_i[23:16], alu_op1_i[31:24] };
+        ALU_BCLR:    alu_result_async_o = alu_op1_i & ~bit_mask;
+        ALU_BEXT:    alu_result_async_o = { 31'b0, alu_op1_i[shamt] };
+        ALU_BINV:    alu_result_async_o = alu_op1_i ^ bit_mask;
+        ALU_BSET:    alu_result_async_o = alu_op1_i | bit_mask;
+        ALU_X:       alu_result_async_o = 32'b0;
+        default:     alu_result_async_o = 32'b0;  // multiply/divide modes are handled by muldiv
     endcase
 end
 
@@ -0,0 +1,120 @@
+`timescale 1ns / 1ps
+`default_nettype none
+
+///
+/// Risc-V CPU Branch Predictor
+///
+/// Specs:
+/// Direct mapped branch target buffer (async read, sync write)
+/// Table of 2-bit saturating counters for conditional branches
+///
+
+module branch_predictor
+    // Import Constants
+    import common::*;
+    import cpu_common::*;
+    #(
+        parameter int unsigned BTB_BITS = 5,           // log2(branch target buffer entries)
+        parameter int unsigned BHT_BITS = 7            // log2(branch history table entries)
+    )
+    (
+        input  wire logic       clk_i,                 // clock
+
+        // prediction port
+        input  wire word_t      pc_i,                  // program counter of the instruction being fetched
+        output      logic       predict_async_o,       // predicted taken
+        output      word_t      target_async_o,        // predicted target
+
+        // training port
+        input  wire bp_update_t update_i               // resolved control transfer
+    );
+
+
+//
+// Tables
+//
+
+localparam int unsigned BTB_TAG_BITS = 32 - BTB_BITS - 1;
+
+typedef logic [BTB_BITS-1:0]     btb_index_t;
+typedef logic [BTB_TAG_BITS-1:0] btb_tag_t;
+typedef logic [BHT_BITS-1:0]     bht_index_t;
+
+typedef struct packed {
+    logic     valid;   // entry in use
+    logic     branch;  // conditional branch (consult history), otherwise an unconditional jump
+    btb_tag_t tag;     // upper program counter bits
+    word_t    target;  // last taken target
+} btb_entry_t;
+
+// 2-bit saturating counters, taken when the high bit is set
+typedef enum logic [1:0] {
+    STRONGLY_NOT_TAKEN = 2'b00,
+    WEAKLY_NOT_TAKEN   = 2'b01,
+    WEAKLY_TAKEN       = 2'b10,
+    STRONGLY_TAKEN     = 2'b11
+} counter_t;
+
+btb_entry_t btb_r [(2**BTB_BITS)-1:0] = '{ default: '0 };
+counter_t   bht_r [(2**BHT_BITS)-1:0] = '{ default: WEAKLY_NOT_TAKEN };
+
+// instructions are halfword aligned, so index from bit 1
+function automatic btb_index_t btb_index(word_t pc);
+    return pc[BTB_BITS:1];
+endfunction
+
+function automatic btb_tag_t btb_tag(word_t pc);
+    return pc[31:BTB_BITS+1];
+endfunction
+
+function automatic bht_index_t bht_index(word_t pc);
+    return pc[BHT_BITS:1];
+endfunction
+
+
+//
+// Prediction
+//
+
+btb_entry_t entry;
+counter_t   counter;
+
+always_comb begin
+    entry   = btb_r[btb_index(pc_i)];
+    counter = bht_r[bht_index(pc_i)];
+
+    predict_async_o = entry.valid && entry.tag == btb_tag(pc_i) && (!entry.branch || counter[1]);
+    target_async_o  = entry.target;
+end
+
+
+//
+// Training
+//
+
+counter_t update_counter;
+
+always_comb begin
+    update_counter = bht_r[bht_index(update_i.pc)];
+
+    if (update_i.taken && update_counter != STRONGLY_TAKEN)
+        update_counter = counter_t'(update_counter + 2'b01);
+    else if (!update_i.taken && update_counter != STRONGLY_NOT_TAKEN)
+        update_counter = counter_t'(update_counter - 2'b01);
+end
+
+always_ff @(posedge clk_i) begin
+    if (update_i.valid) begin
+        if (update_i.taken && !update_i.direct)
+            // remember where taken transfers go
+            btb_r[btb_index(update_i.pc)] <= '{ valid: 1'b1, branch: update_i.branch, tag: btb_tag(update_i.pc), target: update_i.target };
+        else if (!update_i.branch)
+            // not a predicted control transfer (aliased or stale entry), forget it
+            btb_r[btb_index(update_i.pc)] <= '0;
+
+        if (update_i.branch)
+            bht_r[bht_index(update_i.pc)] <= update_counter;
+    end
+end
+
+endmodule
@@ -8,6 +8,7 @@
 module chipset
     // Import Constants
     import common::*;
+    import cpu_common::*;
     (
         // Clock
         input  wire logic         clk_i,
@@ -15,10 +16,14 @@ module chipset
         // CPU Signals
         output wire logic         halt_o,            // halt
         input  wire logic         interrupt_i,       // internal interrupt
+        input  wire logic         timer_interrupt_i, // timer interrupt (mtime >= mtimecmp)
+        input  wire dword_t       mtime_i,           // timer (shadowed by the time CSR)
 
         // Instruction Bus
         output wire word_t        imem_addr_o,
+        output wire logic         imem_read_enable_o,
         input  wire word_t        imem_data_i,
+        input  wire logic         imem_valid_i,
 
         // Data Bus
         output      chip_select_t bus_chip_select_o, // chip select
@@ -26,7 +31,11 @@ module chipset
         input  wire word_t        bus_read_data_i,   // read data
         output wire logic         bus_read_enable_o, // read enable
         output wire word_t        bus_write_data_o,  // write data
-        output wire logic [3:0]   bus_write_mask_o   // write mask
+        output wire logic [3:0]   bus_write_mask_o,  // write mask
+        input  wire logic         bus_read_valid_i,  // read data valid
+
+        // Debug Probes
+        output wire probe_t       probe_o            // cpu probes
     );
 
 
@@ -40,14 +49,20 @@ assign      bus_addr_o = bus_addr;
 cpu cpu (
     .clk_i              (clk_i),
     .interrupt_i        (interrupt_i),
+    .timer_interrupt_i  (timer_interrupt_i),
+    .mtime_i            (mtime_i),
     .halt_o             (halt_o),
     .imem_addr_o        (imem_addr_o),
+    .imem_read_enable_o (imem_read_enable_o),
     .imem_data_i        (imem_data_i),
+    .imem_valid_i       (imem_valid_i),
     .dmem_addr_o        (bus_addr),
     .dmem_read_data_i   (bus_read_data_i),
     .dmem_read_enable_o (bus_read_enable_o),
     .dmem_write_data_o  (bus_write_data_o),
-    .dmem_write_mask_o  (bus_write_mask_o)
+    .dmem_write_mask_o  (bus_write_mask_o),
+    .dmem_read_valid_i  (bus_read_valid_i),
+    .probe_o            (probe_o)
 );
 
 
@@ -58,6 +73,7 @@ cpu cpu (
 // FFFF0000 - R   - Interrupt Controller Pending
 // FFFF0004 - R/W - Interrupt Controller Enabled
 // FFFF0008 - R   - Interrupt Controller Active
+// FFFF000C - R/W - Interrupt Controller Claim/Complete { highest priority active source ID }
 // FFFF0100 - R/W - UART Config  { baud, parity, etc. }
 // FFFF0104 - R   - UART Status  { tx fifo status, rx fifo status, break indicator }
 // FFFF0108 - R   - UART Rx Data { data available, data }
@@ -68,6 +84,10 @@ cpu cpu (
 // FFFF0400 - R   - PS/2 Keyboard Status  { data available, make/break, keycode }
 // FFFF0404 - W   - PS/2 Keyboard Control { caps, num, scroll }
 // FFFF0500 - W   - VGA Font Select
+// FFFF0600 - R/W - Timer mtime (low word)
+// FFFF0604 - R/W - Timer mtime (high word)
+// FFFF0608 - R/W - Timer mtimecmp (low word)
+// FFFF060C - R/W - Timer mtimecmp (high word)
 
 always_comb begin
     bus_chip_select_o = '{ default: '0 };
@@ -81,6 +101,7 @@ always_comb begin
     32'hFFFF03??: bus_chip_select_o.switches = '1;
     32'hFFFF04??: bus_chip_select_o.keyboard = '1;
     32'hFFFF05??: bus_chip_select_o.vga      = '1;
+    32'hFFFF06??: bus_chip_select_o.timer    = '1;
     default: ;
     endcase
 end
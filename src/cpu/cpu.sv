@@ -14,43 +14,83 @@ module cpu
         // board signals
         input  wire logic       clk_i,
         input  wire logic       interrupt_i,
+        input  wire logic       timer_interrupt_i,
+        input  wire dword_t     mtime_i,
         output wire logic       halt_o,
 
         // instruction memory bus
         output wire word_t      imem_addr_o,
+        output wire logic       imem_read_enable_o,
         input  wire word_t      imem_data_i,
+        input  wire logic       imem_valid_i,
 
         // data memory bus
         output wire word_t      dmem_addr_o,
         input  wire word_t      dmem_read_data_i,
         output wire logic       dmem_read_enable_o,
         output wire logic [3:0] dmem_write_mask_o,
-        output wire word_t      dmem_write_data_o
+        output wire word_t      dmem_write_data_o,
+        input  wire logic       dmem_read_valid_i,
+
+        // debug probes
+        output wire probe_t     probe_o
     );
 
 //
 // Signals
 //
 
+wire word_t      if_imem_addr;
+wire word_t      if_imem_data;
+wire logic       if_imem_valid;
+wire word_t      if_imem_data2;
+wire logic       if_imem_valid2;
+wire logic       if_imem_taken;
+wire hpm_events_t if_hpm_events;
 wire word_t      if_pc;
 wire word_t      if_ir;
 wire word_t      if_pc_next;
-wire word_t      id_jmp_addr;
-wire logic       id_jmp_valid;
-wire logic       id_ready;
+wire word_t      if_pred_pc;
+wire word_t      if_pc2;
+wire word_t      if_ir2;
+wire word_t      if_pc_next2;
+wire word_t      if_pred_pc2;
 wire word_t      id_pc;
 wire word_t      id_ir;
-wire word_t      id_alu_op1;
-wire word_t      id_alu_op2;
-wire alu_mode_t  id_alu_mode;
-wire ma_mode_t   id_ma_mode;
-wire ma_size_t   id_ma_size;
-wire word_t      id_ma_data;
-wire wb_src_t    id_wb_src;
-wire regaddr_t   id_wb_addr;
-wire word_t      id_wb_data;
-wire logic       id_wb_ready;
-wire logic       id_wb_valid;
+wire word_t      id_pc_next;
+wire word_t      id_pred_pc;
+wire control_word_t id_cw;
+wire word_t      id_ir2;
+wire fuse_t      id_fuse;
+wire word_t      id_pc2;
+wire control_word2_t id_cw2;
+wire word_t      id_pair_pc;
+wire logic       id_ready;
+wire word_t      rr_jmp_addr;
+wire logic       rr_jmp_valid;
+wire logic       rr_fencei;
+wire logic       rr_ready;
+wire stall_t     rr_stall;
+wire bp_update_t rr_bp_update;
+wire hpm_events_t rr_hpm_events;
+wire word_t      rr_pc;
+wire word_t      rr_ir;
+wire word_t      rr_alu_op1;
+wire word_t      rr_alu_op2;
+wire alu_mode_t  rr_alu_mode;
+wire ma_mode_t   rr_ma_mode;
+wire ma_size_t   rr_ma_size;
+wire word_t      rr_ma_data;
+wire wb_src_t    rr_wb_src;
+wire regaddr_t   rr_wb_addr;
+wire word_t      rr_wb_data;
+wire logic       rr_wb_ready;
+wire logic       rr_wb_valid;
+wire word_t      rr_alu2_op1;
+wire word_t      rr_alu2_op2;
+wire alu_mode_t  rr_alu2_mode;
+wire regaddr_t   rr_wb2_addr;
+wire logic       rr_wb2_valid;
 wire word_t      ex_pc;
 wire word_t      ex_ir;
 wire word_t      ex_ma_addr;
@@ -62,8 +102,27 @@ wire regaddr_t   ex_wb_addr;
 wire word_t      ex_wb_data;
 wire logic       ex_wb_ready;
 wire logic       ex_wb_valid;
+wire regaddr_t   ex_wb2_addr;
+wire word_t      ex_wb2_data;
+wire logic       ex_wb2_valid;
 wire logic       ex_empty;
+wire logic       ex_ready;
 wire logic       ma_empty;
+wire logic       ma_ready;
+wire word_t      ma_dmem_addr;
+wire logic       ma_dmem_read_enable;
+wire word_t      ma_dmem_write_data;
+wire logic [3:0] ma_dmem_write_mask;
+wire logic       ma_dmem_fence;
+wire logic       ma_dmem_ready;
+wire word_t      ma_dmem_read_data;
+wire word_t      sb_addr;
+wire logic       sb_read_enable;
+wire word_t      sb_write_data;
+wire logic [3:0] sb_write_mask;
+wire logic       dc_ready;
+wire word_t      dc_read_data;
+wire hpm_events_t ma_hpm_events;
 wire word_t      ma_pc;
 wire word_t      ma_ir;
 wire logic       ma_load;
@@ -72,12 +131,20 @@ wire regaddr_t   ma_wb_addr;
 wire word_t      ma_wb_data;
 wire logic       ma_wb_ready;
 wire logic       ma_wb_valid;
+wire regaddr_t   ma_wb2_addr;
+wire word_t      ma_wb2_data;
+wire logic       ma_wb2_valid;
 wire ma_size_t   ma_size;
 wire regaddr_t   wb_addr;
 wire word_t      wb_data;
 wire logic       wb_valid;
+wire regaddr_t   wb2_addr;
+wire word_t      wb2_data;
+wire logic       wb2_valid;
 wire logic       wb_empty;
+wire word_t      wb_bypass_data;
 wire logic       csr_retired;
+wire logic       csr_paired;
 wire word_t      csr_trap_pc;
 wire mcause_t    csr_mcause;
 wire logic       csr_mtrap;
@@ -85,9 +152,11 @@ wire logic       csr_mret;
 wire word_t      csr_jmp_addr;
 wire logic       csr_jmp_request;
 wire logic       csr_jmp_accept;
+wire logic       csr_wake;
 wire csr_t       csr_read_addr;
 wire logic       csr_read_enable;
 wire word_t      csr_read_data;
+wire word_t      csr_read_data_async;
 wire csr_t       csr_write_addr;
 wire word_t      csr_write_data;
 wire logic       csr_write_enable;
@@ -97,44 +166,117 @@ wire logic       csr_write_enable;
 // CPU Stages
 //
 
+// Instruction Cache
+icache icache (
+    .clk_i               (clk_i),
+    .cpu_addr_i          (if_imem_addr),
+    .cpu_data_o          (if_imem_data),
+    .cpu_valid_async_o   (if_imem_valid),
+    .cpu_data2_o         (if_imem_data2),
+    .cpu_valid2_async_o  (if_imem_valid2),
+    .cpu_taken_i         (if_imem_taken),
+    .invalidate_i        (rr_fencei),
+    .bus_addr_o          (imem_addr_o),
+    .bus_read_enable_o   (imem_read_enable_o),
+    .bus_data_i          (imem_data_i),
+    .bus_valid_i         (imem_valid_i),
+    .hpm_events_o        (if_hpm_events)
+);
+
 // Instruction Fetch
 stage_fetch fetch (
     .clk_i               (clk_i),
     .halt_i              (halt_o),
-    .imem_addr_o         (imem_addr_o),
-    .imem_data_i         (imem_data_i),
-    .jmp_addr_i          (id_jmp_addr),
-    .jmp_valid_i         (id_jmp_valid),
+    .imem_addr_o         (if_imem_addr),
+    .imem_data_i         (if_imem_data),
+    .imem_valid_i        (if_imem_valid),
+    .imem_data2_i        (if_imem_data2),
+    .imem_valid2_i       (if_imem_valid2),
+    .imem_taken_o        (if_imem_taken),
+    .jmp_addr_i          (rr_jmp_addr),
+    .jmp_valid_i         (rr_jmp_valid),
     .ready_i             (id_ready),
+    .bp_update_i         (rr_bp_update),
     .pc_o                (if_pc),
     .ir_o                (if_ir),
-    .pc_next_o           (if_pc_next)
+    .pc_next_o           (if_pc_next),
+    .pred_pc_o           (if_pred_pc),
+    .pc2_o               (if_pc2),
+    .ir2_o               (if_ir2),
+    .pc_next2_o          (if_pc_next2),
+    .pred_pc2_o          (if_pred_pc2)
 );
 
 // Instruction Decode
 stage_decode decode (
     .clk_i               (clk_i),
     .pc_i                (if_pc),
-    .pc_next_i           (if_pc_next),
     .ir_i                (if_ir),
+    .pc_next_i           (if_pc_next),
+    .pred_pc_i           (if_pred_pc),
+    .pc2_i               (if_pc2),
+    .ir2_i               (if_ir2),
+    .pc_next2_i          (if_pc_next2),
+    .pred_pc2_i          (if_pred_pc2),
+    .flush_i             (rr_jmp_valid || halt_o),
+    .ready_i             (rr_ready),
+    .ready_async_o       (id_ready),
+    .pc_o                (id_pc),
+    .ir_o                (id_ir),
+    .pc_next_o           (id_pc_next),
+    .pred_pc_o           (id_pred_pc),
+    .cw_o                (id_cw),
+    .ir2_o               (id_ir2),
+    .fuse_o              (id_fuse),
+    .pc2_o               (id_pc2),
+    .cw2_o               (id_cw2),
+    .pair_pc_o           (id_pair_pc)
+);
+
+// Register Read
+stage_register_read register_read (
+    .clk_i               (clk_i),
+    .pc_i                (id_pc),
+    .pc_next_i           (id_pc_next),
+    .pred_pc_i           (id_pred_pc),
+    .cw_i                (id_cw),
+    .ir_i                (id_ir),
+    .ir2_i               (id_ir2),
+    .fuse_i              (id_fuse),
+    .pc2_i               (id_pc2),
+    .cw2_i               (id_cw2),
     .ex_wb_addr_i        (ex_wb_addr),
     .ex_wb_data_i        (ex_wb_data),
     .ex_wb_ready_i       (ex_wb_ready),
     .ex_wb_valid_i       (ex_wb_valid),
+    .ex_wb2_addr_i       (ex_wb2_addr),
+    .ex_wb2_data_i       (ex_wb2_data),
+    .ex_wb2_valid_i      (ex_wb2_valid),
     .ex_empty_i          (ex_empty),
+    .ex_ready_i          (ex_ready),
     .ma_wb_addr_i        (ma_wb_addr),
-    .ma_wb_data_i        (ma_wb_data),
-    .ma_wb_ready_i       (ma_wb_ready),
+    .ma_wb_data_i        (wb_bypass_data),
     .ma_wb_valid_i       (ma_wb_valid),
+    .ma_wb2_addr_i       (ma_wb2_addr),
+    .ma_wb2_data_i       (ma_wb2_data),
+    .ma_wb2_valid_i      (ma_wb2_valid),
     .ma_empty_i          (ma_empty),
     .wb_addr_i           (wb_addr),
     .wb_data_i           (wb_data),
     .wb_valid_i          (wb_valid),
+    .wb2_addr_i          (wb2_addr),
+    .wb2_data_i          (wb2_data),
+    .wb2_valid_i         (wb2_valid),
     .wb_empty_i          (wb_empty),
-    .ready_async_o       (id_ready),
-    .jmp_addr_o          (id_jmp_addr),
-    .jmp_valid_o         (id_jmp_valid),
+    .ready_async_o       (rr_ready),
+    .jmp_addr_o          (rr_jmp_addr),
+    .jmp_valid_o         (rr_jmp_valid),
+    .stall_async_o       (rr_stall),
+    .fencei_o            (rr_fencei),
+    .bp_update_o         (rr_bp_update),
+    .hpm_events_o        (rr_hpm_events),
     .csr_retired_o       (csr_retired),
+    .csr_paired_o        (csr_paired),
     .csr_trap_pc_o       (csr_trap_pc),
     .csr_mtrap_o         (csr_mtrap),
     .csr_mret_o          (csr_mret),
@@ -142,45 +284,59 @@ stage_decode decode (
     .csr_jmp_addr_i      (csr_jmp_addr),
     .csr_jmp_request_i   (csr_jmp_request),
     .csr_jmp_accept_o    (csr_jmp_accept),
+    .csr_wake_i          (csr_wake),
     .csr_read_addr_o     (csr_read_addr),
     .csr_read_enable_o   (csr_read_enable),
     .csr_read_data_i     (csr_read_data),
+    .csr_read_async_i    (csr_read_data_async),
     .csr_write_addr_o    (csr_write_addr),
     .csr_write_data_o    (csr_write_data),
     .csr_write_enable_o  (csr_write_enable),
     .halt_o              (halt_o),
-    .pc_o                (id_pc),
-    .ir_o                (id_ir),
-    .alu_op1_o           (id_alu_op1),
-    .alu_op2_o           (id_alu_op2),
-    .alu_mode_o          (id_alu_mode),
-    .ma_mode_o           (id_ma_mode),
-    .ma_size_o           (id_ma_size),
-    .ma_data_o           (id_ma_data),
-    .wb_src_o            (id_wb_src),
-    .wb_addr_o           (id_wb_addr),
-    .wb_data_o           (id_wb_data),
-    .wb_ready_o          (id_wb_ready),
-    .wb_valid_o          (id_wb_valid)
+    .pc_o                (rr_pc),
+    .ir_o                (rr_ir),
+    .alu_op1_o           (rr_alu_op1),
+    .alu_op2_o           (rr_alu_op2),
+    .alu_mode_o          (rr_alu_mode),
+    .ma_mode_o           (rr_ma_mode),
+    .ma_size_o           (rr_ma_size),
+    .ma_data_o           (rr_ma_data),
+    .wb_src_o            (rr_wb_src),
+    .wb_addr_o           (rr_wb_addr),
+    .wb_data_o           (rr_wb_data),
+    .wb_ready_o          (rr_wb_ready),
+    .wb_valid_o          (rr_wb_valid),
+    .alu2_op1_o          (rr_alu2_op1),
+    .alu2_op2_o          (rr_alu2_op2),
+    .alu2_mode_o         (rr_alu2_mode),
+    .wb2_addr_o          (rr_wb2_addr),
+    .wb2_valid_o         (rr_wb2_valid)
 );
 
 // Execute
 stage_execute execute (
     .clk_i               (clk_i),
-    .pc_i                (id_pc),
-    .ir_i                (id_ir),
-    .alu_op1_i           (id_alu_op1),
-    .alu_op2_i           (id_alu_op2),
-    .alu_mode_i          (id_alu_mode),
-    .ma_mode_i           (id_ma_mode),
-    .ma_size_i           (id_ma_size),
-    .ma_data_i           (id_ma_data),
-    .wb_src_i            (id_wb_src),
-    .wb_addr_i           (id_wb_addr),
-    .wb_data_i           (id_wb_data),
-    .wb_ready_i          (id_wb_ready),
-    .wb_valid_i          (id_wb_valid),
+    .pc_i                (rr_pc),
+    .ir_i                (rr_ir),
+    .alu_op1_i           (rr_alu_op1),
+    .alu_op2_i           (rr_alu_op2),
+    .alu_mode_i          (rr_alu_mode),
+    .ma_mode_i           (rr_ma_mode),
+    .ma_size_i           (rr_ma_size),
+    .ma_data_i           (rr_ma_data),
+    .wb_src_i            (rr_wb_src),
+    .wb_addr_i           (rr_wb_addr),
+    .wb_data_i           (rr_wb_data),
+    .wb_ready_i          (rr_wb_ready),
+    .wb_valid_i          (rr_wb_valid),
+    .alu2_op1_i          (rr_alu2_op1),
+    .alu2_op2_i          (rr_alu2_op2),
+    .alu2_mode_i         (rr_alu2_mode),
+    .wb2_addr_i          (rr_wb2_addr),
+    .wb2_valid_i         (rr_wb2_valid),
+    .ready_i             (ma_ready),
     .empty_async_o       (ex_empty),
+    .ready_async_o       (ex_ready),
     .pc_o                (ex_pc),
     .ir_o                (ex_ir),
     .ma_addr_o           (ex_ma_addr),
@@ -191,16 +347,22 @@ stage_execute execute (
     .wb_addr_o           (ex_wb_addr),
     .wb_data_o           (ex_wb_data),
     .wb_ready_o          (ex_wb_ready),
-    .wb_valid_o          (ex_wb_valid)
+    .wb_valid_o          (ex_wb_valid),
+    .wb2_addr_o          (ex_wb2_addr),
+    .wb2_data_o          (ex_wb2_data),
+    .wb2_valid_o         (ex_wb2_valid)
 );
 
 // Memory Access
 stage_memory memory_access (
     .clk_i               (clk_i),
-    .dmem_addr_o         (dmem_addr_o),
-    .dmem_read_enable_o  (dmem_read_enable_o),
-    .dmem_write_data_o   (dmem_write_data_o),
-    .dmem_write_mask_o   (dmem_write_mask_o),
+    .dmem_addr_o         (ma_dmem_addr),
+    .dmem_read_enable_o  (ma_dmem_read_enable),
+    .dmem_write_data_o   (ma_dmem_write_data),
+    .dmem_write_mask_o   (ma_dmem_write_mask),
+    .dmem_fence_o        (ma_dmem_fence),
+    .dmem_ready_i        (ma_dmem_ready),
+    .dmem_read_data_i    (ma_dmem_read_data),
     .pc_i                (ex_pc),
     .ir_i                (ex_ir),
     .ma_addr_i           (ex_ma_addr),
@@ -212,7 +374,11 @@ stage_memory memory_access (
     .wb_data_i           (ex_wb_data),
     .wb_ready_i          (ex_wb_ready),
     .wb_valid_i          (ex_wb_valid),
+    .wb2_addr_i          (ex_wb2_addr),
+    .wb2_data_i          (ex_wb2_data),
+    .wb2_valid_i         (ex_wb2_valid),
     .empty_async_o       (ma_empty),
+    .ready_async_o       (ma_ready),
     .pc_o                (ma_pc),
     .ir_o                (ma_ir),
     .load_o              (ma_load),
@@ -221,13 +387,52 @@ stage_memory memory_access (
     .wb_addr_o           (ma_wb_addr),
     .wb_data_o           (ma_wb_data),
     .wb_ready_o          (ma_wb_ready),
-    .wb_valid_o          (ma_wb_valid)
+    .wb_valid_o          (ma_wb_valid),
+    .wb2_addr_o          (ma_wb2_addr),
+    .wb2_data_o          (ma_wb2_data),
+    .wb2_valid_o         (ma_wb2_valid)
+);
+
+// Store Buffer
+store_buffer store_buffer (
+    .clk_i               (clk_i),
+    .cpu_addr_i          (ma_dmem_addr),
+    .cpu_read_enable_i   (ma_dmem_read_enable),
+    .cpu_write_data_i    (ma_dmem_write_data),
+    .cpu_write_mask_i    (ma_dmem_write_mask),
+    .cpu_fence_i         (ma_dmem_fence),
+    .cpu_ready_async_o   (ma_dmem_ready),
+    .cpu_read_data_o     (ma_dmem_read_data),
+    .mem_addr_o          (sb_addr),
+    .mem_read_enable_o   (sb_read_enable),
+    .mem_write_data_o    (sb_write_data),
+    .mem_write_mask_o    (sb_write_mask),
+    .mem_ready_i         (dc_ready),
+    .mem_read_data_i     (dc_read_data)
+);
+
+// Data Cache
+dcache dcache (
+    .clk_i               (clk_i),
+    .cpu_addr_i          (sb_addr),
+    .cpu_read_enable_i   (sb_read_enable),
+    .cpu_write_data_i    (sb_write_data),
+    .cpu_write_mask_i    (sb_write_mask),
+    .cpu_ready_async_o   (dc_ready),
+    .cpu_read_data_o     (dc_read_data),
+    .bus_addr_o          (dmem_addr_o),
+    .bus_read_enable_o   (dmem_read_enable_o),
+    .bus_write_data_o    (dmem_write_data_o),
+    .bus_write_mask_o    (dmem_write_mask_o),
+    .bus_read_data_i     (dmem_read_data_i),
+    .bus_read_valid_i    (dmem_read_valid_i),
+    .hpm_events_o        (ma_hpm_events)
 );
 
 // Write Back
 stage_writeback writeback (
     .clk_i               (clk_i),
-    .dmem_read_data_i    (dmem_read_data_i),
+    .dmem_read_data_i    (ma_dmem_read_data),
     .pc_i                (ma_pc),
     .ir_i                (ma_ir),
     .load_i              (ma_load),
@@ -237,13 +442,28 @@ stage_writeback writeback (
     .wb_data_i           (ma_wb_data),
     .wb_ready_i          (ma_wb_ready),
     .wb_valid_i          (ma_wb_valid),
+    .wb2_addr_i          (ma_wb2_addr),
+    .wb2_data_i          (ma_wb2_data),
+    .wb2_valid_i         (ma_wb2_valid),
     .wb_addr_o           (wb_addr),
     .wb_data_o           (wb_data),
     .wb_valid_o          (wb_valid),
-    .empty_async_o       (wb_empty)
+    .wb2_addr_o          (wb2_addr),
+    .wb2_data_o          (wb2_data),
+    .wb2_valid_o         (wb2_valid),
+    .empty_async_o       (wb_empty),
+    .wb_data_async_o     (wb_bypass_data)
 );
 
 
+//
+// Performance Counter Events
+//
+
+hpm_events_t hpm_events;
+always_comb hpm_events = if_hpm_events | rr_hpm_events | ma_hpm_events;
+
+
 //
 // CSRs
 //
@@ -251,17 +471,24 @@ stage_writeback writeback (
 csr csr (
     .clk_i               (clk_i),
     .retired_i           (csr_retired),
+    .paired_i            (csr_paired),
+    .unretired_i         (2'(!ex_empty) + 2'(!ma_empty) + 2'(!wb_empty)),
     .interrupt_i         (interrupt_i),
+    .timer_interrupt_i   (timer_interrupt_i),
+    .mtime_i             (mtime_i),
     .trap_pc_i           (csr_trap_pc),
     .mcause_i            (csr_mcause),
     .mtrap_i             (csr_mtrap),
     .mret_i              (csr_mret),
+    .hpm_events_i        (hpm_events),
     .jmp_addr_async_o    (csr_jmp_addr),
     .jmp_request_async_o (csr_jmp_request),
     .jmp_accept_i        (csr_jmp_accept),
+    .wake_async_o        (csr_wake),
     .read_addr_i         (csr_read_addr),
     .read_enable_i       (csr_read_enable),
     .read_data_o         (csr_read_data),
+    .read_data_async_o   (csr_read_data_async),
     .write_addr_i        (csr_write_addr),
     .write_data_i        (csr_write_data),
     .write_enable_i      (csr_write_enable),
@@ -271,4 +498,29 @@ csr csr (
     .lookup2_rwx_async_o ()
 );
 
+
+//
+// Debug Probes
+//
+
+probe_t probe;
+assign  probe_o = probe;
+
+always_comb begin
+    // instructions issue (or stall) in register read, which squashes its input on the cycle after a jump
+    probe.decode_pc    = rr_jmp_valid ? NOP_PC : id_pc;
+    probe.decode_pc2   = rr_jmp_valid ? NOP_PC : id_pair_pc;
+    probe.decode_ready = rr_ready;
+    probe.stall        = rr_stall;
+    probe.jump         = rr_jmp_valid;
+
+    // instructions retire from writeback, except CSR instructions which execute in register read
+    probe.retire_pc    = (ma_pc != NOP_PC) ? ma_pc : csr_retired ? id_pc : NOP_PC;
+
+    // a jump accepted while neither trapping nor returning is an interrupt
+    probe.irq_taken = csr_jmp_accept && !csr_mtrap && !csr_mret;
+
+    probe.events    = hpm_events;
+end
+
 endmodule
@@ -15,6 +15,20 @@ typedef logic [4:0]  regaddr_t;
 // CSR Address
 typedef logic [11:0] csr_t;
 
+// Dual Issue (build with ENABLE_DUAL_ISSUE to issue an independent ALU instruction alongside another)
+`ifdef ENABLE_DUAL_ISSUE
+localparam bit DUAL_ISSUE = 1'b1;
+`else
+localparam bit DUAL_ISSUE = 1'b0;
+`endif
+
+// Misaligned Traps (build with ENABLE_TRAP_MISALIGNED to trap misaligned loads and stores instead of splitting them)
+`ifdef ENABLE_TRAP_MISALIGNED
+localparam bit TRAP_MISALIGNED = 1'b1;
+`else
+localparam bit TRAP_MISALIGNED = 1'b0;
+`endif
+
 
 ///
 /// Instruction Decoding
@@ -33,6 +47,7 @@ localparam opcode_t OP_IMM       = 7'b0010011; // Integer Register-Immediate Ins
 localparam opcode_t OP           = 7'b0110011; // Integer Register-Register Operations
 localparam opcode_t OP_MISC_MEM  = 7'b0001111; // Miscellaneous Memory Operations
 localparam opcode_t OP_SYSTEM    = 7'b1110011; // System Calls
+localparam opcode_t OP_AMO       = 7'b0101111; // Atomic Memory Operations
 
 // Funct3
 typedef logic [2:0] funct3_t;
@@ -80,8 +95,55 @@ localparam funct3_t F3_CSRRWI    = 3'b101;     // Atomic R/W Immedate CSR
 localparam funct3_t F3_CSRRSI    = 3'b110;     // Atomic RSB Immedate CSR
 localparam funct3_t F3_CSRRCI    = 3'b111;     // Atomic RC Immedate CSR
 
+// Funct3 (OP_AMO)
+localparam funct3_t F3_AMO_W     = 3'b010;     // Word
+
+// Funct3 (OP with F7_MULDIV)
+localparam funct3_t F3_MUL       = 3'b000;     // Multiply (Low Word)
+localparam funct3_t F3_MULH      = 3'b001;     // Multiply (High Word, Signed x Signed)
+localparam funct3_t F3_MULHSU    = 3'b010;     // Multiply (High Word, Signed x Unsigned)
+localparam funct3_t F3_MULHU     = 3'b011;     // Multiply (High Word, Unsigned x Unsigned)
+localparam funct3_t F3_DIV       = 3'b100;     // Divide (Signed)
+localparam funct3_t F3_DIVU      = 3'b101;     // Divide (Unsigned)
+localparam funct3_t F3_REM       = 3'b110;     // Remainder (Signed)
+localparam funct3_t F3_REMU      = 3'b111;     // Remainder (Unsigned)
+
+// Funct3 (OP with F7_SHADD)
+localparam funct3_t F3_SH1ADD    = 3'b010;     // Shift Left by 1 and Add
+localparam funct3_t F3_SH2ADD    = 3'b100;     // Shift Left by 2 and Add
+localparam funct3_t F3_SH3ADD    = 3'b110;     // Shift Left by 3 and Add
+
+// Funct3 (OP with F7_MINMAX)
+localparam funct3_t F3_MIN       = 3'b100;     // Minimum (Signed)
+localparam funct3_t F3_MINU      = 3'b101;     // Minimum (Unsigned)
+localparam funct3_t F3_MAX       = 3'b110;     // Maximum (Signed)
+localparam funct3_t F3_MAXU      = 3'b111;     // Maximum (Unsigned)
+
 // Funct7
 typedef logic [6:0] funct7_t;
+localparam funct7_t F7_MULDIV    = 7'b0000001; // M Extension
+localparam funct7_t F7_SHADD     = 7'b0010000; // Zba Shift and Add
+localparam funct7_t F7_INVERT    = 7'b0100000; // Zbb Logic with Inverted Operand (also SUB/SRA)
+localparam funct7_t F7_MINMAX    = 7'b0000101; // Zbb Minimum/Maximum
+localparam funct7_t F7_ZEXTH     = 7'b0000100; // Zbb Zero Extend Half-Word (rs2 = 0)
+localparam funct7_t F7_ROTATE    = 7'b0110000; // Zbb Rotate (and the Count/Sign Extend immediates)
+localparam funct7_t F7_BSET_ORCB = 7'b0010100; // Zbs Set Bit (f3 = 001), Zbb OR-Combine Bytes (f3 = 101)
+localparam funct7_t F7_BINV_REV8 = 7'b0110100; // Zbs Invert Bit (f3 = 001), Zbb Reverse Bytes (f3 = 101)
+localparam funct7_t F7_BCLR_BEXT = 7'b0100100; // Zbs Clear Bit (f3 = 001), Extract Bit (f3 = 101)
+
+// Funct5 (OP_AMO, the top of funct7 above the aq and rl bits)
+typedef logic [4:0] funct5_t;
+localparam funct5_t F5_LR        = 5'b00010;   // Load Reserved
+localparam funct5_t F5_SC        = 5'b00011;   // Store Conditional
+localparam funct5_t F5_AMOSWAP   = 5'b00001;   // Swap
+localparam funct5_t F5_AMOADD    = 5'b00000;   // Add
+localparam funct5_t F5_AMOXOR    = 5'b00100;   // Binary XOR
+localparam funct5_t F5_AMOAND    = 5'b01100;   // Binary AND
+localparam funct5_t F5_AMOOR     = 5'b01000;   // Binary OR
+localparam funct5_t F5_AMOMIN    = 5'b10000;   // Minimum (Signed)
+localparam funct5_t F5_AMOMAX    = 5'b10100;   // Maximum (Signed)
+localparam funct5_t F5_AMOMINU   = 5'b11000;   // Minimum (Unsigned)
+localparam funct5_t F5_AMOMAXU   = 5'b11100;   // Maximum (Unsigned)
 
 // Funct12
 typedef logic [11:0] funct12_t;
@@ -120,27 +182,68 @@ typedef enum logic [2:0] {
     ALU_OP2_PC   = 3'b100      // Program Counter
 } alu_op2_t;
 
-// ALU Mode
-typedef enum logic [3:0] {
-    ALU_ADD      = 4'b0000,    // Addition
-    ALU_LSL      = 4'b0001,    // Logical Shift Left
-    ALU_SLT      = 4'b0010,    // Less-Than (Signed)
-    ALU_ULT      = 4'b0011,    // Less-Than (Unsigned)
-    ALU_XOR      = 4'b0100,    // Binary XOR
-    ALU_LSR      = 4'b0101,    // Logical Shift Right
-    ALU_OR       = 4'b0110,    // Binary OR
-    ALU_AND      = 4'b0111,    // Binary AND
-    ALU_SUB      = 4'b1000,    // Subtraction
-    ALU_ASR      = 4'b1101,    // Logical Shift Right
-    ALU_COPY1    = 4'b1110,    // Output Operand #1
-    ALU_X        = 4'b1111     // Disabled
+// ALU Mode (6'b00xxxx follow { funct7[5], funct3 }, 6'b010xxx select the multi-cycle multiply/divide unit,
+// which uses the low bits as funct3, and 6'b1xxxxx are the bit manipulation extensions)
+typedef enum logic [5:0] {
+    ALU_ADD      = 6'b000000,  // Addition
+    ALU_LSL      = 6'b000001,  // Logical Shift Left
+    ALU_SLT      = 6'b000010,  // Less-Than (Signed)
+    ALU_ULT      = 6'b000011,  // Less-Than (Unsigned)
+    ALU_XOR      = 6'b000100,  // Binary XOR
+    ALU_LSR      = 6'b000101,  // Logical Shift Right
+    ALU_OR       = 6'b000110,  // Binary OR
+    ALU_AND      = 6'b000111,  // Binary AND
+    ALU_SUB      = 6'b001000,  // Subtraction
+    ALU_ASR      = 6'b001101,  // Logical Shift Right
+    ALU_COPY1    = 6'b001110,  // Output Operand #1
+    ALU_X        = 6'b001111,  // Disabled
+    ALU_MUL      = 6'b010000,  // Multiply (Low Word)
+    ALU_MULH     = 6'b010001,  // Multiply (High Word, Signed x Signed)
+    ALU_MULHSU   = 6'b010010,  // Multiply (High Word, Signed x Unsigned)
+    ALU_MULHU    = 6'b010011,  // Multiply (High Word, Unsigned x Unsigned)
+    ALU_DIV      = 6'b010100,  // Divide (Signed)
+    ALU_DIVU     = 6'b010101,  // Divide (Unsigned)
+    ALU_REM      = 6'b010110,  // Remainder (Signed)
+    ALU_REMU     = 6'b010111,  // Remainder (Unsigned)
+    ALU_LSL_LSR  = 6'b011000,  // Shift Left by op2[4:0], then Right by op2[9:5] (fused slli+srli)
+    ALU_SH1ADD   = 6'b100000,  // Shift Left by 1 and Add (Zba)
+    ALU_SH2ADD   = 6'b100001,  // Shift Left by 2 and Add (Zba)
+    ALU_SH3ADD   = 6'b100010,  // Shift Left by 3 and Add (Zba)
+    ALU_ANDN     = 6'b100011,  // AND with Inverted Operand #2 (Zbb)
+    ALU_ORN      = 6'b100100,  // OR with Inverted Operand #2 (Zbb)
+    ALU_XNOR     = 6'b100101,  // Binary XNOR (Zbb)
+    ALU_CLZ      = 6'b100110,  // Count Leading Zeros (Zbb)
+    ALU_CTZ      = 6'b100111,  // Count Trailing Zeros (Zbb)
+    ALU_CPOP     = 6'b101000,  // Count Set Bits (Zbb)
+    ALU_MIN      = 6'b101001,  // Minimum (Signed) (Zbb)
+    ALU_MINU     = 6'b101010,  // Minimum (Unsigned) (Zbb)
+    ALU_MAX      = 6'b101011,  // Maximum (Signed) (Zbb)
+    ALU_MAXU     = 6'b101100,  // Maximum (Unsigned) (Zbb)
+    ALU_SEXTB    = 6'b101101,  // Sign Extend Byte (Zbb)
+    ALU_SEXTH    = 6'b101110,  // Sign Extend Half-Word (Zbb)
+    ALU_ZEXTH    = 6'b101111,  // Zero Extend Half-Word (Zbb)
+    ALU_ROL      = 6'b110000,  // Rotate Left (Zbb)
+    ALU_ROR      = 6'b110001,  // Rotate Right (Zbb)
+    ALU_ORCB     = 6'b110010,  // OR-Combine Bytes (Zbb)
+    ALU_REV8     = 6'b110011,  // Reverse Bytes (Zbb)
+    ALU_BCLR     = 6'b110100,  // Clear Bit (Zbs)
+    ALU_BEXT     = 6'b110101,  // Extract Bit (Zbs)
+    ALU_BINV     = 6'b110110,  // Invert Bit (Zbs)
+    ALU_BSET     = 6'b110111   // Set Bit (Zbs)
 } alu_mode_t;
 
+// multi-cycle multiply/divide operations
+function automatic logic is_muldiv(alu_mode_t mode);
+    return mode inside { ALU_MUL, ALU_MULH, ALU_MULHSU, ALU_MULHU, ALU_DIV, ALU_DIVU, ALU_REM, ALU_REMU };
+endfunction
+
 // Memory Access Mode
-typedef enum logic [1:0] {
-    MA_X         = 2'b00,       // No memory access
-    MA_LOAD      = 2'b01,       // Load memory to register
-    MA_STORE     = 2'b10        // Store ALU in memory
+typedef enum logic [2:0] {
+    MA_X         = 3'b000,      // No memory access
+    MA_LOAD      = 3'b001,      // Load memory to register
+    MA_STORE     = 3'b010,      // Store ALU in memory
+    MA_FENCE     = 3'b011,      // Wait for buffered stores to drain
+    MA_AMO       = 3'b100       // Atomic memory operation (lr, sc or read-modify-write)
 } ma_mode_t;
 
 // Memory Access Size
@@ -154,6 +257,28 @@ typedef enum logic [2:0] {
 
 localparam ma_size_t MA_SIZE_X = MA_SIZE_W;
 
+// access isn't naturally aligned
+function automatic logic is_misaligned(ma_size_t size, logic [1:0] offset);
+    unique case (size)
+    MA_SIZE_B,
+    MA_SIZE_BU: return 1'b0;
+    MA_SIZE_H,
+    MA_SIZE_HU: return offset[0];
+    default:    return offset != 2'b00;
+    endcase
+endfunction
+
+// access spills into the next word, so takes two memory accesses
+function automatic logic crosses_word(ma_size_t size, logic [1:0] offset);
+    unique case (size)
+    MA_SIZE_B,
+    MA_SIZE_BU: return 1'b0;
+    MA_SIZE_H,
+    MA_SIZE_HU: return offset == 2'b11;
+    default:    return offset != 2'b00;
+    endcase
+endfunction
+
 // Write-Back Source
 typedef enum logic [1:0] {
     WB_SRC_X     = 2'b00,      // Disabled
@@ -162,6 +287,14 @@ typedef enum logic [1:0] {
     WB_SRC_MEM   = 2'b11       // Data from Memory
 } wb_src_t;
 
+// Macro-Op Fusion (an adjacent pair issued as one operation)
+typedef enum logic [1:0] {
+    FUSE_NONE       = 2'b00,   // Not fused
+    FUSE_LUI_ADDI   = 2'b01,   // lui rd, hi; addi rd, rd, lo     (32-bit constant)
+    FUSE_AUIPC_JALR = 2'b10,   // auipc rd, hi; jalr rd, lo(rd)   (far call)
+    FUSE_SLLI_SRLI  = 2'b11    // slli rd, rs, n; srli rd, rd, m  (bit field extract)
+} fuse_t;
+
 
 //
 // Control Word
@@ -183,6 +316,22 @@ typedef struct packed {
     logic      priv;
 } control_word_t;
 
+// the part of the control word a paired second instruction needs (it only ever uses the ALU)
+typedef struct packed {
+    logic      halt;
+    alu_op1_t  alu_op1;
+    alu_op2_t  alu_op2;
+    alu_mode_t alu_mode;
+    logic      wb_valid;
+    logic      ra_used;
+    logic      rb_used;
+} control_word2_t;
+
+function automatic control_word2_t to_control_word2(control_word_t cw);
+    return '{ halt: cw.halt, alu_op1: cw.alu_op1, alu_op2: cw.alu_op2, alu_mode: cw.alu_mode,
+              wb_valid: cw.wb_valid, ra_used: cw.ra_used, rb_used: cw.rb_used };
+endfunction
+
 
 //
 // NOP
@@ -200,4 +349,101 @@ localparam regaddr_t  NOP_WB_ADDR  = 5'b00000;
 localparam wb_src_t   NOP_WB_SRC   = WB_SRC_X;
 localparam logic      NOP_WB_VALID = 1'b0;
 
+// control word of NOP_IR (addi x0, x0, 0)
+localparam control_word_t NOP_CW = '{
+    halt:     1'b0,
+    pc_mode:  PC_NEXT,
+    alu_op1:  ALU_OP1_RS1,
+    alu_op2:  ALU_OP2_IMMI,
+    alu_mode: ALU_ADD,
+    ma_mode:  MA_X,
+    ma_size:  MA_SIZE_W,
+    wb_src:   WB_SRC_ALU,
+    wb_valid: 1'b0,
+    ra_used:  1'b0,
+    rb_used:  1'b0,
+    csr_used: 1'b0,
+    priv:     1'b0
+};
+
+// no paired second instruction
+localparam control_word2_t NOP_CW2 = to_control_word2(NOP_CW);
+
+
+//
+// Branch Prediction
+//
+
+typedef struct packed {
+    logic  valid;   // RR resolved a control transfer (or a misprediction)
+    word_t pc;      // program counter of the resolved instruction
+    logic  branch;  // conditional branch (trains the history table)
+    logic  direct;  // direct jump (predecoded by fetch, not cached)
+    logic  taken;   // control transferred to target
+    word_t target;  // target address when taken
+    logic  call;    // call (pushes the return address stack)
+    logic  ret;     // return (pops the return address stack)
+    word_t link;    // return address pushed by a call
+} bp_update_t;
+
+localparam regaddr_t REG_RA = 5'd1;  // return address register (x1)
+
+// jal/jalr that links through ra
+function automatic logic is_call(word_t ir);
+    return (ir[6:0] == OP_JAL || ir[6:0] == OP_JALR) && ir[11:7] == REG_RA;
+endfunction
+
+// jalr x0, 0(ra) and friends
+function automatic logic is_return(word_t ir);
+    return ir[6:0] == OP_JALR && ir[11:7] == 5'd0 && ir[19:15] == REG_RA;
+endfunction
+
+
+//
+// Performance Counters
+//
+
+// event n is counted by mhpmcounter(3+n)
+localparam int HPM_BRANCH_HIT       = 0;  // control transfer predicted correctly
+localparam int HPM_BRANCH_MISS      = 1;  // control transfer mispredicted
+localparam int HPM_RETURN_HIT       = 2;  // return predicted correctly
+localparam int HPM_RETURN_MISS      = 3;  // return mispredicted
+localparam int HPM_ICACHE_HIT       = 4;  // instruction cache lookup hit
+localparam int HPM_ICACHE_MISS      = 5;  // instruction cache lookup missed (line fill)
+localparam int HPM_DCACHE_HIT       = 6;  // data cache access hit
+localparam int HPM_DCACHE_MISS      = 7;  // data cache access missed (line fill)
+localparam int HPM_DCACHE_WRITEBACK = 8;  // data cache miss evicted a dirty line
+localparam int HPM_FUSE_LUI_ADDI    = 9;  // lui+addi issued as one operation
+localparam int HPM_FUSE_AUIPC_JALR  = 10; // auipc+jalr issued as one operation
+localparam int HPM_FUSE_SLLI_SRLI   = 11; // slli+srli issued as one operation
+localparam int HPM_DUAL_ISSUE       = 12; // two instructions issued together (ENABLE_DUAL_ISSUE)
+localparam int HPM_EVENTS           = 13;
+
+typedef logic [HPM_EVENTS-1:0] hpm_events_t;
+
+
+//
+// Debug Probes
+//
+
+// Decode Stall Cause
+typedef enum logic [2:0] {
+    STALL_NONE   = 3'b000,     // Not stalled
+    STALL_DATA   = 3'b001,     // Waiting on a data hazard
+    STALL_CSR    = 3'b010,     // Flushing/executing a CSR instruction
+    STALL_WFI    = 3'b011,     // Waiting for an interrupt
+    STALL_MEMORY = 3'b100      // Waiting on a data cache miss
+} stall_t;
+
+typedef struct packed {
+    word_t       decode_pc;     // program counter of the instruction issuing from RR (NOP_PC if none)
+    word_t       decode_pc2;    // program counter of the second instruction of a pair issuing with it (NOP_PC if none)
+    logic        decode_ready;  // RR accepting its instruction (not stalled)
+    stall_t      stall;         // why RR is stalled
+    logic        jump;          // RR redirecting fetch (squashing the instructions behind it)
+    word_t       retire_pc;     // program counter of the instruction retiring (NOP_PC if none)
+    logic        irq_taken;     // external interrupt accepted by the pipeline
+    hpm_events_t events;        // performance counter events
+} probe_t;
+
 endpackage
@@ -17,21 +17,28 @@ module csr
 
         // control port
         input  wire logic       retired_i,           // did an instruction retire this cycle
+        input  wire logic [1:0] unretired_i,         // older instructions still in flight (counted by instret reads)
+        input  wire logic       paired_i,            // a pair issued (counts its second instruction)
         input  wire logic       interrupt_i,         // external interrupt indicator
+        input  wire logic       timer_interrupt_i,   // timer interrupt indicator (mtime >= mtimecmp)
+        input  wire dword_t     mtime_i,             // memory mapped timer (shadowed by time)
         input  wire word_t      trap_pc_i,           // trap location
         input  wire mcause_t    mcause_i,            // trap cause
         input  wire logic       mtrap_i,             // trap valid
         input  wire logic       mret_i,              // ret valid
+        input  wire hpm_events_t hpm_events_i,       // performance counter events
 
         // pipeline control
         output      word_t      jmp_addr_async_o,    // jump address (driven by interrupts/trap/etc.)
         output      logic       jmp_request_async_o, // jump request
         input  wire logic       jmp_accept_i,        // accept jump request
+        output      logic       wake_async_o,        // enabled interrupt pending (ends WFI, even if globally disabled)
 
         // CSR read port
         input  wire csr_t       read_addr_i,
         input  wire logic       read_enable_i,
-        output wire word_t      read_data_o,
+        output wire word_t      read_data_o,         // data at the previous cycle's address (if enabled)
+        output      word_t      read_data_async_o,   // data at the current address
 
         // CSR write port
         input  wire csr_t       write_addr_i,
@@ -159,7 +166,7 @@ localparam mcause_t MCAUSE_DEFAULT = '{
 // Counters
 dword_t  mcycle_r,   mcycle_next;            // cycle counter
 dword_t  minstret_r, minstret_next;          // retired instruction counter
-dword_t  time_r,     time_next;              // time counter
+dword_t  mhpmcounter_r [HPM_EVENTS-1:0] = '{ default: '0 }; // performance counters
 
 // Non-Counters
 mtvec_t  mtvec_r         = MTVEC_DEFAULT;         // trap vector
@@ -175,7 +182,7 @@ logic    mstatus_mie;                             // global interrupt enabled
 logic    mstatus_mpie_r  = 1'b0;                  // global interrupt enabled (prior)
 logic    mstatus_mpie;                            // global interrupt enabled (prior)
 logic    meip;                                    // machine external interrupt pending
-logic    mtip_r          = 1'b0;                  // machine timer    interrupt pending
+logic    mtip;                                    // machine timer    interrupt pending
 logic    msip_r          = 1'b0;                  // machine software interrupt pending
 logic    meie_r          = 1'b0;                  // machine external interrupt enabled
 logic    mtie_r          = 1'b0;                  // machine timer    interrupt enabled
@@ -188,13 +195,24 @@ logic    msie_r          = 1'b0;                  // machine software interrupt
 
 always_comb begin
     mcycle_next   = mcycle_r + 1;
-    time_next     = time_r + 1;
-    minstret_next = retired_i ? (minstret_r + 1) : minstret_r;
+    minstret_next = minstret_r + dword_t'(retired_i) + dword_t'(paired_i);
 
     if (mcountinhibit_r[0]) mcycle_next   = mcycle_r;
     if (mcountinhibit_r[2]) minstret_next = minstret_r;
 end
 
+// mhpmcounter(3+n) counts event n
+always_ff @(posedge clk_i) begin
+    for (int i=0; i<HPM_EVENTS; i++) begin
+        if (write_enable_i && write_addr_i == CSR_MHPMCOUNTER3 + csr_t'(i))
+            mhpmcounter_r[i] <= { mhpmcounter_r[i][63:32], write_data_i };
+        else if (write_enable_i && write_addr_i == CSR_MHPMCOUNTER3H + csr_t'(i))
+            mhpmcounter_r[i] <= { write_data_i, mhpmcounter_r[i][31:0] };
+        else if (hpm_events_i[i] && !mcountinhibit_r[3+i])
+            mhpmcounter_r[i] <= mhpmcounter_r[i] + 1;
+    end
+end
+
 
 //
 // Trap Handling
@@ -203,13 +221,21 @@ end
 // interrupt pending
 always_comb begin
     meip = interrupt_i;
+    mtip = timer_interrupt_i;
 end
 
 // interrupt enablement
 logic interrupt;
+exc_t interrupt_cause;
 always_comb begin
     // interrupt if interrupt is pending, enabled, and globally enabled
-    interrupt = meip && meie_r && mstatus_mie_r;
+    interrupt = ((meip && meie_r) || (mtip && mtie_r)) && mstatus_mie_r;
+
+    // external interrupts take priority over the timer
+    interrupt_cause = (meip && meie_r) ? INT_M_EXTERNAL : INT_M_TIMER;
+
+    // WFI resumes on any enabled pending interrupt, whether or not it will be taken
+    wake_async_o = (meip && meie_r) || (mtip && mtie_r);
 end
 
 // jump requests
@@ -226,10 +252,11 @@ always_comb begin
         MTVEC_MODE_DIRECT:
             jmp_addr_async_o = { mtvec_r.base, 2'b00 };
         MTVEC_MODE_VECTORED:
-            unique if (interrupt_i)
-                jmp_addr_async_o = { mtvec_r.base + INT_M_EXTERNAL[29:0], 2'b00 };
-            else
+            // traps win over interrupts (see mcause), and use the base entry
+            unique if (mtrap_i)
                 jmp_addr_async_o = { mtvec_r.base,                        2'b00 };
+            else
+                jmp_addr_async_o = { mtvec_r.base + interrupt_cause[29:0], 2'b00 };
         endcase
     end else begin
         jmp_addr_async_o = 32'b0;
@@ -268,8 +295,8 @@ always_ff @(posedge clk_i) begin
         // trap causes are provided
         mcause_r <= mcause_i;
     else if (jmp_accept_i && interrupt)
-        // interrupt cause is always the same
-        mcause_r <= { 1'b1, INT_M_EXTERNAL };
+        // interrupt cause is the highest priority enabled interrupt
+        mcause_r <= { 1'b1, interrupt_cause };
     else if (jmp_accept_i && mret_i)
         // on return, cause is set back to default
         mcause_r <= MCAUSE_DEFAULT;
@@ -311,60 +338,75 @@ always_comb mie_o = '{
 mi_t mip_o;
 always_comb mip_o = '{
     mei:     meip,
-    mti:     mtip_r,
+    mti:     mtip,
     msi:     msip_r,
     default: '0
 };
 
+// mhpmcounterN[h] and their read-only hpmcounterN[h] shadows
+logic  hpm_read;
+word_t hpm_read_data;
+always_comb begin
+    hpm_read      = (read_addr_i[11:8] == 4'hB || read_addr_i[11:8] == 4'hC) && read_addr_i[6:5] == 2'b00 && read_addr_i[4:0] >= 5'd3;
+    hpm_read_data = 32'b0;
+    for (int i=0; i<HPM_EVENTS; i++)
+        if (read_addr_i[4:0] == 5'(3+i))
+            hpm_read_data = read_addr_i[7] ? mhpmcounter_r[i][63:32] : mhpmcounter_r[i][31:0];
+end
+
+// instructions ahead of a pipelined read will retire before it, so instret includes them
+dword_t minstret_read;
+always_comb minstret_read = minstret_r + dword_t'(unretired_i);
+
+always_comb begin
+    unique case (read_addr_i)
+    //                                       MXLEN=32           ZYXWVUTSRQPONMLKJIHGFEDCBA
+    CSR_MISA:          read_data_async_o = { 2'b01,   4'b0, 26'b00000000000001000100000111 };
+    CSR_MVENDORID:     read_data_async_o = 32'b0;
+    CSR_MARCHID:       read_data_async_o = 32'b0;
+    CSR_MIMPID:        read_data_async_o = 32'h0001;
+    CSR_MHARTID:       read_data_async_o = 32'b0;
+    CSR_MSTATUS:       read_data_async_o = mstatus_o;
+    CSR_MTVEC:         read_data_async_o = mtvec_r;
+    CSR_MCOUNTINHIBIT: read_data_async_o = mcountinhibit_r;
+    CSR_MSCRATCH:      read_data_async_o = mscratch_r;
+    CSR_MCAUSE:        read_data_async_o = mcause_r;
+    CSR_MEPC:          read_data_async_o = mepc_r;
+    CSR_MTVAL:         read_data_async_o = mtval_r;
+    CSR_MTVAL2:        read_data_async_o = mtval2_r;
+    CSR_MTINST:        read_data_async_o = mtinst_r;
+    CSR_MIP:           read_data_async_o = mip_o;
+    CSR_MIE:           read_data_async_o = mie_o;
+    CSR_MCYCLE,
+    CSR_CYCLE:         read_data_async_o = mcycle_r[31:0];
+    CSR_TIME:          read_data_async_o = mtime_i[31:0];
+    CSR_MINSTRET,
+    CSR_INSTRET:       read_data_async_o = minstret_read[31:0];
+    CSR_MCYCLEH,
+    CSR_CYCLEH:        read_data_async_o = mcycle_r[63:32];
+    CSR_TIMEH:         read_data_async_o = mtime_i[63:32];
+    CSR_MINSTRETH,
+    CSR_INSTRETH:      read_data_async_o = minstret_read[63:32];
+    (CSR_PMPCFG0+0):   read_data_async_o = { PMP_CONFIG[3].cfg, PMP_CONFIG[2].cfg, PMP_CONFIG[1].cfg, PMP_CONFIG[0].cfg };
+    (CSR_PMPCFG0+1):   read_data_async_o = { PMP_CONFIG[7].cfg, PMP_CONFIG[6].cfg, PMP_CONFIG[5].cfg, PMP_CONFIG[4].cfg };
+    (CSR_PMPCFG0+2):   read_data_async_o = { 8'b0,              8'b0,              8'b0,              PMP_CONFIG[8].cfg };
+    (CSR_PMPADDR0+0):  read_data_async_o = PMP_CONFIG[0].addr;
+    (CSR_PMPADDR0+1):  read_data_async_o = PMP_CONFIG[1].addr;
+    (CSR_PMPADDR0+2):  read_data_async_o = PMP_CONFIG[2].addr;
+    (CSR_PMPADDR0+3):  read_data_async_o = PMP_CONFIG[3].addr;
+    (CSR_PMPADDR0+4):  read_data_async_o = PMP_CONFIG[4].addr;
+    (CSR_PMPADDR0+5):  read_data_async_o = PMP_CONFIG[5].addr;
+    (CSR_PMPADDR0+6):  read_data_async_o = PMP_CONFIG[6].addr;
+    (CSR_PMPADDR0+7):  read_data_async_o = PMP_CONFIG[7].addr;
+    (CSR_PMPADDR0+8):  read_data_async_o = PMP_CONFIG[8].addr;
+    default:           read_data_async_o = hpm_read ? hpm_read_data : 32'b0;
+    endcase
+end
+
 word_t read_data_r = '0;
 
 always_ff @(posedge clk_i) begin
-    if (read_enable_i) begin
-        unique case (read_addr_i)
-        //                                  MXLEN=32           ZYXWVUTSRQPONMLKJIHGFEDCBA
-        CSR_MISA:          read_data_r <= { 2'b01,   4'b0, 26'b00000000000000000100000100 };
-        CSR_MVENDORID:     read_data_r <= 32'b0;
-        CSR_MARCHID:       read_data_r <= 32'b0;
-        CSR_MIMPID:        read_data_r <= 32'h0001;
-        CSR_MHARTID:       read_data_r <= 32'b0;
-        CSR_MSTATUS:       read_data_r <= mstatus_o;
-        CSR_MTVEC:         read_data_r <= mtvec_r;
-        CSR_MCOUNTINHIBIT: read_data_r <= mcountinhibit_r;
-        CSR_MSCRATCH:      read_data_r <= mscratch_r;
-        CSR_MCAUSE:        read_data_r <= mcause_r;
-        CSR_MEPC:          read_data_r <= mepc_r;
-        CSR_MTVAL:         read_data_r <= mtval_r;
-        CSR_MTVAL2:        read_data_r <= mtval2_r;
-        CSR_MTINST:        read_data_r <= mtinst_r;
-        CSR_MIP:           read_data_r <= mip_o;
-        CSR_MIE:           read_data_r <= mie_o;
-        CSR_MCYCLE,
-        CSR_CYCLE:         read_data_r <= mcycle_r[31:0];
-        CSR_TIME:          read_data_r <= time_r[31:0];
-        CSR_MINSTRET,
-        CSR_INSTRET:       read_data_r <= minstret_r[31:0];
-        CSR_MCYCLEH,
-        CSR_CYCLEH:        read_data_r <= mcycle_r[63:32];
-        CSR_TIMEH:         read_data_r <= time_r[63:32];
-        CSR_MINSTRETH,
-        CSR_INSTRETH:      read_data_r <= minstret_r[63:32];
-        (CSR_PMPCFG0+0):   read_data_r <= { PMP_CONFIG[3].cfg, PMP_CONFIG[2].cfg, PMP_CONFIG[1].cfg, PMP_CONFIG[0].cfg };
-        (CSR_PMPCFG0+1):   read_data_r <= { PMP_CONFIG[7].cfg, PMP_CONFIG[6].cfg, PMP_CONFIG[5].cfg, PMP_CONFIG[4].cfg };
-        (CSR_PMPCFG0+2):   read_data_r <= { 8'b0,              8'b0,              8'b0,              PMP_CONFIG[8].cfg };
-        (CSR_PMPADDR0+0):  read_data_r <= PMP_CONFIG[0].addr;
-        (CSR_PMPADDR0+1):  read_data_r <= PMP_CONFIG[1].addr;
-        (CSR_PMPADDR0+2):  read_data_r <= PMP_CONFIG[2].addr;
-        (CSR_PMPADDR0+3):  read_data_r <= PMP_CONFIG[3].addr;
-        (CSR_PMPADDR0+4):  read_data_r <= PMP_CONFIG[4].addr;
-        (CSR_PMPADDR0+5):  read_data_r <= PMP_CONFIG[5].addr;
-        (CSR_PMPADDR0+6):  read_data_r <= PMP_CONFIG[6].addr;
-        (CSR_PMPADDR0+7):  read_data_r <= PMP_CONFIG[7].addr;
-        (CSR_PMPADDR0+8):  read_data_r <= PMP_CONFIG[8].addr;
-        default:           read_data_r <= 32'b0;
-        endcase
-    end else begin
-        read_data_r <= 32'b0;
-    end
+    read_data_r <= read_enable_i ? read_data_async_o : 32'b0;
 end
 
 assign read_data_o = read_data_r;
@@ -383,14 +425,12 @@ always_comb mie_i = mi_t'(write_data_i[15:0]);
 always_ff @(posedge clk_i) begin
     if (write_enable_i) begin
         case (write_addr_i)
-        CSR_MTVEC:          mtvec_r         <= write_data_i;
+        CSR_MTVEC:          mtvec_r         <= { write_data_i[31:2], 1'b0, write_data_i[0] };
         CSR_MCOUNTINHIBIT:  mcountinhibit_r <= write_data_i;
         CSR_MSCRATCH:       mscratch_r      <= write_data_i;
         CSR_CYCLE:          mcycle_r        <= { mcycle_next  [63:32], write_data_i };
-        CSR_TIME:           time_r          <= { time_next    [63:32], write_data_i };
         CSR_INSTRET:        minstret_r      <= { minstret_next[63:32], write_data_i };
         CSR_CYCLEH:         mcycle_r        <= { write_data_i, mcycle_next   [31:0] };
-        CSR_TIMEH:          time_r          <= { write_data_i, time_next     [31:0] };
         CSR_INSTRETH:       minstret_r      <= { write_data_i, minstret_next [31:0] };
         CSR_MIE:
             begin
@@ -401,7 +441,6 @@ always_ff @(posedge clk_i) begin
         endcase
     end else begin
         mcycle_r   <= mcycle_next;
-        time_r     <= time_next;
         minstret_r <= minstret_next;
     end
 end
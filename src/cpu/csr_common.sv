@@ -44,12 +44,12 @@ localparam csr_t CSR_PMPADDR63      = 12'h3EF; // Implemented
 // Machine Counters/Timers
 localparam csr_t CSR_MCYCLE         = 12'hB00; // Implemented
 localparam csr_t CSR_MINSTRET       = 12'hB02; // Implemented
-localparam csr_t CSR_MHPMCOUNTER3   = 12'hB03; // Not Implemented
-localparam csr_t CSR_MHPMCOUNTER31  = 12'hB1F; // Not Implemented
+localparam csr_t CSR_MHPMCOUNTER3   = 12'hB03; // Implemented (HPM_EVENTS counters)
+localparam csr_t CSR_MHPMCOUNTER31  = 12'hB1F; // Implemented (HPM_EVENTS counters)
 localparam csr_t CSR_MCYCLEH        = 12'hB80; // Implemented
 localparam csr_t CSR_MINSTRETH      = 12'hB82; // Implemented
-localparam csr_t CSR_MHPMCOUNTER3H  = 12'hB83; // Not Implemented
-localparam csr_t CSR_MHPMCOUNTER31H = 12'hB9F; // Not Implemented
+localparam csr_t CSR_MHPMCOUNTER3H  = 12'hB83; // Implemented (HPM_EVENTS counters)
+localparam csr_t CSR_MHPMCOUNTER31H = 12'hB9F; // Implemented (HPM_EVENTS counters)
 
 // Machine Counter Setup
 localparam csr_t CSR_MCOUNTINHIBIT  = 12'h320; // Implemented
@@ -60,13 +60,13 @@ localparam csr_t CSR_MHPMEVENT31    = 12'h33F; // Not Implemented
 localparam csr_t CSR_CYCLE          = 12'hC00; // Implemented
 localparam csr_t CSR_TIME           = 12'hC01; // Implemented
 localparam csr_t CSR_INSTRET        = 12'hC02; // Implemented
-localparam csr_t CSR_HPMCOUNTER3    = 12'hC03; // Not Implemented
-localparam csr_t CSR_HPMCOUNTER31   = 12'hC1F; // Not Implemented
+localparam csr_t CSR_HPMCOUNTER3    = 12'hC03; // Implemented (HPM_EVENTS counters)
+localparam csr_t CSR_HPMCOUNTER31   = 12'hC1F; // Implemented (HPM_EVENTS counters)
 localparam csr_t CSR_CYCLEH         = 12'hC80; // Implemented
 localparam csr_t CSR_TIMEH          = 12'hC81; // Implemented
 localparam csr_t CSR_INSTRETH       = 12'hC82; // Implemented
-localparam csr_t CSR_HPMCOUNTER3H   = 12'hC83; // Not Implemented
-localparam csr_t CSR_HPMCOUNTER31H  = 12'hC9F; // Not Implemented
+localparam csr_t CSR_HPMCOUNTER3H   = 12'hC83; // Implemented (HPM_EVENTS counters)
+localparam csr_t CSR_HPMCOUNTER31H  = 12'hC9F; // Implemented (HPM_EVENTS counters)
 
 
 //
@@ -0,0 +1,262 @@
+`timescale 1ns / 1ps
+`default_nettype none
+
+///
+/// Risc-V CPU Data Cache
+///
+/// Specs:
+/// Direct mapped, write-back, write-allocate, 2**LINE_BITS words per line, 2**INDEX_BITS lines
+/// Only RAM (0x1xxxxxxx) is cached, other regions pass straight through to the bus
+/// Hits and uncached accesses are accepted immediately, read data follows a cycle later
+/// Misses hold off the request (ready low) while the victim is written back and the line filled
+/// Uncached devices must answer reads in one cycle
+///
+
+module dcache
+    // Import Constants
+    import common::*;
+    import cpu_common::*;
+    #(
+        parameter int unsigned LINE_BITS  = 2,         // log2(words per line)
+        parameter int unsigned INDEX_BITS = 6          // log2(lines)
+    )
+    (
+        input  wire logic        clk_i,                // clock
+
+        // cpu port
+        input  wire word_t       cpu_addr_i,           // address
+        input  wire logic        cpu_read_enable_i,    // read enable
+        input  wire word_t       cpu_write_data_i,     // write data
+        input  wire logic [3:0]  cpu_write_mask_i,     // write mask
+        output      logic        cpu_ready_async_o,    // request accepted this cycle
+        output      word_t       cpu_read_data_o,      // read data of the previous cycle's accepted request
+
+        // bus port
+        output      word_t       bus_addr_o,           // address
+        output      logic        bus_read_enable_o,    // read enable
+        output      word_t       bus_write_data_o,     // write data
+        output      logic [3:0]  bus_write_mask_o,     // write mask
+        input  wire word_t       bus_read_data_i,      // read data
+        input  wire logic        bus_read_valid_i,     // read data valid (responses are in request order)
+
+        // performance counter events
+        output wire hpm_events_t hpm_events_o
+    );
+
+
+//
+// Address Decomposition
+//
+
+localparam int unsigned TAG_BITS = 32 - INDEX_BITS - LINE_BITS - 2;
+
+typedef logic [LINE_BITS-1:0]  offset_t;
+typedef logic [INDEX_BITS-1:0] index_t;
+typedef logic [TAG_BITS-1:0]   tag_t;
+
+function automatic offset_t offset(word_t addr);
+    return addr[LINE_BITS+1:2];
+endfunction
+
+function automatic index_t index(word_t addr);
+    return addr[INDEX_BITS+LINE_BITS+1:LINE_BITS+2];
+endfunction
+
+function automatic tag_t tag(word_t addr);
+    return addr[31:INDEX_BITS+LINE_BITS+2];
+endfunction
+
+function automatic logic cacheable(word_t addr);
+    return addr[31:28] == 4'h1;
+endfunction
+
+
+//
+// Storage
+//
+
+// tags are read asynchronously (distributed RAM) so hits are known in the request cycle,
+// data is block RAM friendly (sync read), valid and dirty bits are registers
+logic [(2**INDEX_BITS)-1:0] valid_r = '0;
+logic [(2**INDEX_BITS)-1:0] dirty_r = '0;
+tag_t  tag_r  [(2**INDEX_BITS)-1:0];
+word_t data_r [(2**(INDEX_BITS+LINE_BITS))-1:0];
+
+
+//
+// State Machine
+//
+
+typedef enum logic [1:0] {
+    S_LOOKUP    = 2'b00,  // serving requests
+    S_WRITEBACK = 2'b01,  // writing the dirty victim line to the bus
+    S_FILL      = 2'b10   // filling the missing line from the bus
+} state_t;
+
+state_t state_r = S_LOOKUP;
+state_t state_next;
+
+// request classification
+logic access;
+logic cached;
+logic hit;
+logic miss;
+always_comb begin
+    access = cpu_read_enable_i || (cpu_write_mask_i != 4'b0000);
+    cached = access && cacheable(cpu_addr_i);
+    hit    = (state_r == S_LOOKUP) && cached && valid_r[index(cpu_addr_i)] && tag_r[index(cpu_addr_i)] == tag(cpu_addr_i);
+    miss   = (state_r == S_LOOKUP) && cached && !hit;
+
+    cpu_ready_async_o = (state_r == S_LOOKUP) && !miss;
+end
+
+// line transfer progress
+word_t   miss_addr_r   = '0;   // address being filled
+tag_t    victim_tag_r  = '0;   // tag of the line being written back
+offset_t read_r        = '0;   // next word to read (array during write-back, bus during fill)
+logic    reading_r     = 1'b0; // more words to read
+logic    writing_r     = 1'b0; // victim word ready to write to the bus
+offset_t write_r       = '0;   // victim word being written
+word_t   victim_data_r = '0;   // victim word being written
+offset_t response_r    = '0;   // next fill word to arrive
+logic    written;
+logic    filled;
+
+always_comb begin
+    written = (state_r == S_WRITEBACK) && writing_r && (write_r == '1);
+    filled  = (state_r == S_FILL) && bus_read_valid_i && (response_r == '1);
+
+    unique case (state_r)
+    S_LOOKUP:    state_next = !miss   ? S_LOOKUP :
+                              (valid_r[index(cpu_addr_i)] && dirty_r[index(cpu_addr_i)]) ? S_WRITEBACK : S_FILL;
+    S_WRITEBACK: state_next = written ? S_FILL   : S_WRITEBACK;
+    S_FILL:      state_next = filled  ? S_LOOKUP : S_FILL;
+    default:     state_next = S_LOOKUP;
+    endcase
+end
+
+// bus access
+always_comb begin
+    unique case (state_r)
+    S_WRITEBACK:
+        begin
+            bus_addr_o        = { victim_tag_r, index(miss_addr_r), write_r, 2'b00 };
+            bus_read_enable_o = 1'b0;
+            bus_write_data_o  = victim_data_r;
+            bus_write_mask_o  = writing_r ? 4'b1111 : 4'b0000;
+        end
+    S_FILL:
+        begin
+            bus_addr_o        = { miss_addr_r[31:LINE_BITS+2], read_r, 2'b00 };
+            bus_read_enable_o = reading_r;
+            bus_write_data_o  = 32'b0;
+            bus_write_mask_o  = 4'b0000;
+        end
+    default:
+        begin
+            // uncached requests go straight through
+            bus_addr_o        = cpu_addr_i;
+            bus_read_enable_o = access && !cached && cpu_read_enable_i;
+            bus_write_data_o  = cpu_write_data_i;
+            bus_write_mask_o  = (access && !cached) ? cpu_write_mask_i : 4'b0000;
+        end
+    endcase
+end
+
+always_ff @(posedge clk_i) begin
+    state_r <= state_next;
+
+    // a miss writes back the victim (if dirty), then fills from the first word of the line
+    if (miss) begin
+        miss_addr_r  <= cpu_addr_i;
+        victim_tag_r <= tag_r[index(cpu_addr_i)];
+        read_r       <= '0;
+        reading_r    <= 1'b1;
+        writing_r    <= 1'b0;
+        response_r   <= '0;
+    end
+
+    // write-back reads the victim from the array, and writes it to the bus a cycle later
+    if (state_r == S_WRITEBACK) begin
+        if (reading_r) begin
+            victim_data_r <= data_r[{ index(miss_addr_r), read_r }];
+            write_r       <= read_r;
+            read_r        <= read_r + 1'b1;
+            reading_r     <= (read_r != '1);
+        end
+        writing_r <= reading_r;
+
+        // restart the counters for the fill
+        if (written) begin
+            read_r    <= '0;
+            reading_r <= 1'b1;
+            writing_r <= 1'b0;
+        end
+    end
+
+    // fill requests each word in turn and writes them as they arrive
+    if (state_r == S_FILL) begin
+        if (reading_r) begin
+            read_r    <= read_r + 1'b1;
+            reading_r <= (read_r != '1);
+        end
+
+        if (bus_read_valid_i) begin
+            data_r[{ index(miss_addr_r), response_r }] <= bus_read_data_i;
+            response_r <= response_r + 1'b1;
+        end
+
+        if (filled) begin
+            tag_r[index(miss_addr_r)]   <= tag(miss_addr_r);
+            valid_r[index(miss_addr_r)] <= 1'b1;
+            dirty_r[index(miss_addr_r)] <= 1'b0;
+        end
+    end
+
+    // store hits update the line and mark it dirty
+    if (hit && cpu_write_mask_i != 4'b0000) begin
+        for (int i=0; i<4; i++)
+            if (cpu_write_mask_i[i])
+                data_r[{ index(cpu_addr_i), offset(cpu_addr_i) }][i*8 +: 8] <= cpu_write_data_i[i*8 +: 8];
+        dirty_r[index(cpu_addr_i)] <= 1'b1;
+    end
+end
+
+
+//
+// Read Data
+//
+
+word_t read_data_r = '0;
+logic  uncached_r  = 1'b0;
+
+always_ff @(posedge clk_i) begin
+    read_data_r <= data_r[{ index(cpu_addr_i), offset(cpu_addr_i) }];
+    uncached_r  <= (state_r == S_LOOKUP) && access && !cached;
+end
+
+always_comb begin
+    cpu_read_data_o = uncached_r ? bus_read_data_i : read_data_r;
+end
+
+
+//
+// Performance Counter Events
+//
+
+hpm_events_t hpm_events_r = '0;
+assign       hpm_events_o = hpm_events_r;
+
+// the access that missed is retried (and hits) right after its fill, don't count it twice
+logic retry_r = 1'b0;
+
+always_ff @(posedge clk_i) begin
+    retry_r <= filled;
+
+    hpm_events_r                       <= '0;
+    hpm_events_r[HPM_DCACHE_HIT]       <= hit && !retry_r;
+    hpm_events_r[HPM_DCACHE_MISS]      <= miss;
+    hpm_events_r[HPM_DCACHE_WRITEBACK] <= miss && state_next == S_WRITEBACK;
+end
+
+endmodule
@@ -33,7 +33,7 @@ alu_mode_t   alu_mode;
 
 always_comb begin
     { f7, rs2, rs1, f3, rd, opcode } = ir_i;
-    alu_mode = alu_mode_t'({ f7[5], f3 });
+    alu_mode = alu_mode_t'({ 2'b00, f7[5], f3 });
 end
 
 
@@ -49,7 +49,7 @@ always_comb begin
     //                                     Halt  PC Mode      Alu Op #1     Alu Op #2     Alu Mode     Memory Mode  Memory Size       Writeback Source  WB Valid?  RA Used?  RB Used?  CSR Used?  Priv?
     //                                     ----  -----------  ------------  ------------  -----------  -----------  ----------------  ----------------  ---------  --------  --------  ---------  -----
     { 3'b???,     OP_IMM      }: cw = '{ 1'b0, PC_NEXT,     ALU_OP1_RS1,  ALU_OP2_IMMI, alu_mode,  MA_X,        MA_SIZE_W,        WB_SRC_ALU,       1'b0,      1'b1,     1'b0,     1'b0,      1'b0  };
-    { 3'b???,     OP_LUI      }: cw = '{ 1'b0, PC_NEXT,     ALU_OP1_IMMU, ALU_OP2_RS2,  ALU_COPY1, MA_X,        MA_SIZE_W,        WB_SRC_ALU,       1'b0,      1'b0,     1'b1,     1'b0,      1'b0  };
+    { 3'b???,     OP_LUI      }: cw = '{ 1'b0, PC_NEXT,     ALU_OP1_IMMU, ALU_OP2_X,    ALU_COPY1, MA_X,        MA_SIZE_W,        WB_SRC_ALU,       1'b0,      1'b0,     1'b0,     1'b0,      1'b0  };
     { 3'b???,     OP_AUIPC    }: cw = '{ 1'b0, PC_NEXT,     ALU_OP1_IMMU, ALU_OP2_PC,   ALU_ADD,   MA_X,        MA_SIZE_W,        WB_SRC_ALU,       1'b0,      1'b0,     1'b0,     1'b0,      1'b0  };
     { 3'b???,     OP          }: cw = '{ 1'b0, PC_NEXT,     ALU_OP1_RS1,  ALU_OP2_RS2,  alu_mode,  MA_X,        MA_SIZE_W,        WB_SRC_ALU,       1'b0,      1'b1,     1'b1,     1'b0,      1'b0  };
     { 3'b???,     OP_JAL      }: cw = '{ 1'b0, PC_JUMP_REL, ALU_OP1_X,    ALU_OP2_X,    ALU_X,     MA_X,        MA_SIZE_W,        WB_SRC_PC4,       1'b0,      1'b0,     1'b0,     1'b0,      1'b0  };
@@ -62,7 +62,8 @@ always_comb begin
     { F3_BGEU,    OP_BRANCH   }: cw = '{ 1'b0, PC_BRANCH,   ALU_OP1_X,    ALU_OP2_X,    ALU_X,     MA_X,        MA_SIZE_X,        WB_SRC_X,         1'b0,      1'b1,     1'b1,     1'b0,      1'b0  };
     { 3'b???,     OP_LOAD     }: cw = '{ 1'b0, PC_NEXT,     ALU_OP1_RS1,  ALU_OP2_IMMI, ALU_ADD,   MA_LOAD,     ma_size_t'(f3), WB_SRC_MEM,       1'b0,      1'b1,     1'b1,     1'b0,      1'b0  };
     { 3'b???,     OP_STORE    }: cw = '{ 1'b0, PC_NEXT,     ALU_OP1_RS1,  ALU_OP2_IMMS, ALU_ADD,   MA_STORE,    ma_size_t'(f3), WB_SRC_X,         1'b0,      1'b1,     1'b1,     1'b0,      1'b0  };
-    { 3'b???,     OP_MISC_MEM }: cw = '{ 1'b0, PC_NEXT,     ALU_OP1_X,    ALU_OP2_X,    ALU_X,     MA_X,        MA_SIZE_X,        WB_SRC_X,         1'b0,      1'b0,     1'b0,     1'b0,      1'b0  };
+    { 3'b???,     OP_MISC_MEM }: cw = '{ 1'b0, PC_NEXT,     ALU_OP1_X,    ALU_OP2_X,    ALU_X,     MA_FENCE,    MA_SIZE_X,        WB_SRC_X,         1'b0,      1'b0,     1'b0,     1'b0,      1'b0  };
+    { F3_AMO_W,   OP_AMO      }: cw = '{ 1'b0, PC_NEXT,     ALU_OP1_RS1,  ALU_OP2_X,    ALU_ADD,   MA_AMO,      MA_SIZE_W,        WB_SRC_MEM,       1'b0,      1'b1,     1'b1,     1'b0,      1'b0  };
     { F3_PRIV,    OP_SYSTEM   }: cw = '{ 1'b0, PC_NEXT,     ALU_OP1_X,    ALU_OP2_X,    ALU_X,     MA_X,        MA_SIZE_X,        WB_SRC_X,         1'b0,      1'b0,     1'b0,     1'b0,      1'b1  };
     { F3_CSRRW,   OP_SYSTEM   }: cw = '{ 1'b0, PC_NEXT,     ALU_OP1_X,    ALU_OP2_X,    ALU_X,     MA_X,        MA_SIZE_X,        WB_SRC_X,         1'b0,      1'b1,     1'b0,     1'b1,      1'b0  };
     { F3_CSRRS,   OP_SYSTEM   }: cw = '{ 1'b0, PC_NEXT,     ALU_OP1_X,    ALU_OP2_X,    ALU_X,     MA_X,        MA_SIZE_X,        WB_SRC_X,         1'b0,      1'b1,     1'b0,     1'b1,      1'b0  };
@@ -76,6 +77,59 @@ always_comb begin
     if (opcode == OP_IMM && f3 != F3_SRL_SRA && f3 != F3_SLL)
         cw.alu_mode[3] = 1'b0;
 
+    if (opcode == OP && f7 == F7_MULDIV)
+        cw.alu_mode = alu_mode_t'({ 3'b010, f3 });
+
+    // Zba, Zbb and Zbs share the OP and OP_IMM encodings, told apart by funct7 (and rs2 for the unary operations)
+    if (opcode == OP) begin
+        unique case ({ f7, f3 })
+        { F7_SHADD,     F3_SH1ADD  }: cw.alu_mode = ALU_SH1ADD;
+        { F7_SHADD,     F3_SH2ADD  }: cw.alu_mode = ALU_SH2ADD;
+        { F7_SHADD,     F3_SH3ADD  }: cw.alu_mode = ALU_SH3ADD;
+        { F7_INVERT,    F3_AND     }: cw.alu_mode = ALU_ANDN;
+        { F7_INVERT,    F3_OR      }: cw.alu_mode = ALU_ORN;
+        { F7_INVERT,    F3_XOR     }: cw.alu_mode = ALU_XNOR;
+        { F7_MINMAX,    F3_MIN     }: cw.alu_mode = ALU_MIN;
+        { F7_MINMAX,    F3_MINU    }: cw.alu_mode = ALU_MINU;
+        { F7_MINMAX,    F3_MAX     }: cw.alu_mode = ALU_MAX;
+        { F7_MINMAX,    F3_MAXU    }: cw.alu_mode = ALU_MAXU;
+        { F7_ZEXTH,     F3_XOR     }: cw.alu_mode = ALU_ZEXTH;
+        { F7_ROTATE,    F3_SLL     }: cw.alu_mode = ALU_ROL;
+        { F7_ROTATE,    F3_SRL_SRA }: cw.alu_mode = ALU_ROR;
+        { F7_BCLR_BEXT, F3_SLL     }: cw.alu_mode = ALU_BCLR;
+        { F7_BCLR_BEXT, F3_SRL_SRA }: cw.alu_mode = ALU_BEXT;
+        { F7_BINV_REV8, F3_SLL     }: cw.alu_mode = ALU_BINV;
+        { F7_BSET_ORCB, F3_SLL     }: cw.alu_mode = ALU_BSET;
+        default:                      ;
+        endcase
+    end
+
+    if (opcode == OP_IMM) begin
+        unique casez ({ f7, rs2, f3 })
+        { F7_ROTATE,    5'b00000, F3_SLL     }: cw.alu_mode = ALU_CLZ;
+        { F7_ROTATE,    5'b00001, F3_SLL     }: cw.alu_mode = ALU_CTZ;
+        { F7_ROTATE,    5'b00010, F3_SLL     }: cw.alu_mode = ALU_CPOP;
+        { F7_ROTATE,    5'b00100, F3_SLL     }: cw.alu_mode = ALU_SEXTB;
+        { F7_ROTATE,    5'b00101, F3_SLL     }: cw.alu_mode = ALU_SEXTH;
+        { F7_ROTATE,    5'b?????, F3_SRL_SRA }: cw.alu_mode = ALU_ROR;
+        { F7_BSET_ORCB, 5'b00111, F3_SRL_SRA }: cw.alu_mode = ALU_ORCB;
+        { F7_BINV_REV8, 5'b11000, F3_SRL_SRA }: cw.alu_mode = ALU_REV8;
+        { F7_BCLR_BEXT, 5'b?????, F3_SLL     }: cw.alu_mode = ALU_BCLR;
+        { F7_BCLR_BEXT, 5'b?????, F3_SRL_SRA }: cw.alu_mode = ALU_BEXT;
+        { F7_BINV_REV8, 5'b?????, F3_SLL     }: cw.alu_mode = ALU_BINV;
+        { F7_BSET_ORCB, 5'b?????, F3_SLL     }: cw.alu_mode = ALU_BSET;
+        default:                                ;
+        endcase
+    end
+
+    // zext.h is the rs2 = x0 case of pack, the rest of funct7 0000100 (Zbkb pack and packh) isn't implemented
+    if (opcode == OP && f7 == F7_ZEXTH && !(f3 == F3_XOR && rs2 == 5'b0))
+        cw.halt = 1'b1;
+
+    // the aq and rl bits need nothing more, as memory accesses are performed in order
+    if (opcode == OP_AMO && !(f7[6:2] inside { F5_LR, F5_SC, F5_AMOSWAP, F5_AMOADD, F5_AMOXOR, F5_AMOAND, F5_AMOOR, F5_AMOMIN, F5_AMOMAX, F5_AMOMINU, F5_AMOMAXU }))
+        cw.halt = 1'b1;
+
     cw.ra_used  = cw.ra_used && (rs1 != 5'b0);
     cw.rb_used  = cw.rb_used && (rs2 != 5'b0);
     cw.wb_valid = (cw.wb_src != WB_SRC_X) && (rd != 5'b0);
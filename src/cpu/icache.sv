@@ -0,0 +1,189 @@
+`timescale 1ns / 1ps
+`default_nettype none
+
+///
+/// Risc-V CPU Instruction Cache
+///
+/// Specs:
+/// Direct mapped, 2**LINE_BITS words per line, 2**INDEX_BITS lines
+/// Hits return data the cycle after the request, like a block RAM
+/// Misses stall until the line is filled from the instruction bus (any latency)
+/// Also returns the following word when it hits (even in the next line), so fetch can take
+/// an instruction that straddles two words in one cycle
+///
+
+module icache
+    // Import Constants
+    import common::*;
+    import cpu_common::*;
+    #(
+        parameter int unsigned LINE_BITS  = 2,         // log2(words per line)
+        parameter int unsigned INDEX_BITS = 6          // log2(lines)
+    )
+    (
+        input  wire logic        clk_i,                // clock
+
+        // cpu port
+        input  wire word_t       cpu_addr_i,           // address
+        output wire word_t       cpu_data_o,           // data at the previous cycle's address
+        output      logic        cpu_valid_async_o,    // data valid (hit)
+        output wire word_t       cpu_data2_o,          // data at the previous cycle's address + 4
+        output      logic        cpu_valid2_async_o,   // following data valid (both words hit)
+        input  wire logic        cpu_taken_i,          // fetch consumed the data this cycle
+        input  wire logic        invalidate_i,         // invalidate all lines (fence.i)
+
+        // bus port
+        output      word_t       bus_addr_o,           // address
+        output      logic        bus_read_enable_o,    // read request
+        input  wire word_t       bus_data_i,           // read data
+        input  wire logic        bus_valid_i,          // read data valid (responses are in request order)
+
+        // performance counter events
+        output wire hpm_events_t hpm_events_o
+    );
+
+
+//
+// Address Decomposition
+//
+
+localparam int unsigned TAG_BITS = 32 - INDEX_BITS - LINE_BITS - 2;
+
+typedef logic [LINE_BITS-1:0]  offset_t;
+typedef logic [INDEX_BITS-1:0] index_t;
+typedef logic [TAG_BITS-1:0]   tag_t;
+
+function automatic offset_t offset(word_t addr);
+    return addr[LINE_BITS+1:2];
+endfunction
+
+function automatic index_t index(word_t addr);
+    return addr[INDEX_BITS+LINE_BITS+1:LINE_BITS+2];
+endfunction
+
+function automatic tag_t tag(word_t addr);
+    return addr[31:INDEX_BITS+LINE_BITS+2];
+endfunction
+
+
+//
+// Storage
+//
+
+// tags and data are block RAM friendly (sync read, the second read port is only written while filling),
+// valid bits are registers so they can be cleared at once
+logic [(2**INDEX_BITS)-1:0] valid_r = '0;
+tag_t  tag_r  [(2**INDEX_BITS)-1:0];
+word_t data_r [(2**(INDEX_BITS+LINE_BITS))-1:0];
+
+
+//
+// State Machine
+//
+
+typedef enum logic [0:0] {
+    S_LOOKUP = 1'b0,  // serving requests
+    S_FILL   = 1'b1   // filling a line from the bus
+} state_t;
+
+state_t state_r = S_LOOKUP;
+state_t state_next;
+
+// lookup of the previous cycle's request
+word_t addr_r    = '0;
+word_t addr2_r   = '0;
+logic  lookup_r  = 1'b0;
+tag_t  lookup_tag_r;
+tag_t  lookup_tag2_r;
+word_t lookup_data_r;
+word_t lookup_data2_r;
+assign cpu_data_o  = lookup_data_r;
+assign cpu_data2_o = lookup_data2_r;
+
+// only the first word fills on a miss, fetch asks for the second word again once it needs it
+logic hit;
+logic hit2;
+logic miss;
+always_comb begin
+    hit                = lookup_r && valid_r[index(addr_r)]  && lookup_tag_r  == tag(addr_r);
+    hit2               = lookup_r && valid_r[index(addr2_r)] && lookup_tag2_r == tag(addr2_r);
+    miss               = lookup_r && !hit;
+    cpu_valid_async_o  = hit;
+    cpu_valid2_async_o = hit && hit2;
+end
+
+// line fill progress
+word_t   fill_addr_r = '0;
+offset_t request_r   = '0;
+logic    requesting_r = 1'b0;
+offset_t response_r  = '0;
+logic    filled;
+
+always_comb begin
+    filled = (state_r == S_FILL) && bus_valid_i && (response_r == '1);
+
+    unique case (state_r)
+    S_LOOKUP: state_next = miss   ? S_FILL   : S_LOOKUP;
+    S_FILL:   state_next = filled ? S_LOOKUP : S_FILL;
+    endcase
+
+    bus_addr_o        = { fill_addr_r[31:LINE_BITS+2], request_r, 2'b00 };
+    bus_read_enable_o = (state_r == S_FILL) && requesting_r;
+end
+
+always_ff @(posedge clk_i) begin
+    state_r <= state_next;
+
+    // start a fill from the first word of the missing line
+    if (miss) begin
+        fill_addr_r  <= addr_r;
+        request_r    <= '0;
+        requesting_r <= 1'b1;
+        response_r   <= '0;
+    end
+
+    // request each word of the line in turn
+    if (bus_read_enable_o) begin
+        request_r    <= request_r + 1'b1;
+        requesting_r <= (request_r != '1);
+    end
+
+    // write each word as it arrives, and the tag with the last one
+    if (state_r == S_FILL && bus_valid_i) begin
+        data_r[{ index(fill_addr_r), response_r }] <= bus_data_i;
+        response_r <= response_r + 1'b1;
+        if (filled)
+            tag_r[index(fill_addr_r)] <= tag(fill_addr_r);
+    end
+
+    // valid bits
+    if (invalidate_i)
+        valid_r <= '0;
+    else if (filled)
+        valid_r[index(fill_addr_r)] <= 1'b1;
+
+    // lookup, only trusted when no fill is writing the arrays
+    addr_r         <= cpu_addr_i;
+    addr2_r        <= cpu_addr_i + 32'd4;
+    lookup_r       <= (state_r == S_LOOKUP) && (state_next == S_LOOKUP);
+    lookup_tag_r   <= tag_r[index(cpu_addr_i)];
+    lookup_tag2_r  <= tag_r[index(cpu_addr_i + 32'd4)];
+    lookup_data_r  <= data_r[{ index(cpu_addr_i), offset(cpu_addr_i) }];
+    lookup_data2_r <= data_r[{ index(cpu_addr_i + 32'd4), offset(cpu_addr_i + 32'd4) }];
+end
+
+
+//
+// Performance Counter Events
+//
+
+hpm_events_t hpm_events_r = '0;
+assign       hpm_events_o = hpm_events_r;
+
+always_ff @(posedge clk_i) begin
+    hpm_events_r                   <= '0;
+    hpm_events_r[HPM_ICACHE_HIT]   <= hit && cpu_taken_i;   // not the repeated hits of a stalled fetch
+    hpm_events_r[HPM_ICACHE_MISS]  <= miss;
+end
+
+endmodule
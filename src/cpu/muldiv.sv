@@ -0,0 +1,170 @@
+`timescale 1ns / 1ps
+`default_nettype none
+
+///
+/// Risc-V CPU Multiply/Divide Unit (M Extension)
+///
+/// Specs:
+/// Multiplies in two cycles in EX (a single registered 33x33 signed product, DSP friendly)
+/// Divides with an iterative radix-4 restoring divider (16 steps, 18 cycles in EX)
+/// Result is valid until the EX stage takes it
+///
+
+module muldiv
+    // Import Constants
+    import common::*;
+    import cpu_common::*;
+    (
+        input  wire logic      clk_i,              // clock
+
+        // operation
+        input  wire logic      valid_i,            // operation requested (held until the result is taken)
+        input  wire funct3_t   f3_i,               // operation (funct3 of ALU_MUL..ALU_REMU)
+        input  wire word_t     op1_i,              // operand 1
+        input  wire word_t     op2_i,              // operand 2
+        input  wire logic      ready_i,            // result taken this cycle (if valid)
+
+        // result
+        output      logic      done_async_o,       // result available
+        output      word_t     result_async_o      // result
+    );
+
+
+//
+// State Machine
+//
+
+typedef enum logic [1:0] {
+    S_IDLE   = 2'b00,  // waiting for an operation
+    S_DIVIDE = 2'b01,  // dividing
+    S_DONE   = 2'b10   // result ready
+} state_t;
+
+state_t state_r = S_IDLE;
+
+funct3_t f3;
+logic    divide;
+always_comb begin
+    f3     = f3_i;
+    divide = f3[2];
+end
+
+
+//
+// Multiplier
+//
+
+// operands are sign extended to 33 bits as needed, so one signed product covers all four variants
+logic signed [32:0] mul_op1;
+logic signed [32:0] mul_op2;
+always_comb begin
+    mul_op1 = { (f3 == F3_MULH || f3 == F3_MULHSU) && op1_i[31], op1_i };
+    mul_op2 = { (f3 == F3_MULH)                    && op2_i[31], op2_i };
+end
+
+// only the low 64 bits of the 66 bit product are ever needed
+logic [63:0] product_r = '0;
+
+
+//
+// Divider
+//
+
+logic [31:0] dividend;  // |op1|
+logic [31:0] divisor;   // |op2|
+always_comb begin
+    dividend = (f3 == F3_DIV || f3 == F3_REM) && op1_i[31] ? -op1_i : op1_i;
+    divisor  = (f3 == F3_DIV || f3 == F3_REM) && op2_i[31] ? -op2_i : op2_i;
+end
+
+word_t      quotient_r  = '0;  // dividend bits still to be shifted out, quotient digits shifted in
+word_t      remainder_r = '0;
+word_t      divisor_r   = '0;
+logic [3:0] step_r      = '0;
+
+// one radix-4 step: bring down two dividend bits, subtract the largest multiple of the divisor that fits
+logic [33:0] partial;
+logic [33:0] divisor1;
+logic [33:0] divisor2;
+logic [33:0] divisor3;
+word_t       partial_next;  // the remainder is always below the divisor, so fits in 32 bits
+logic [1:0]  digit;
+always_comb begin
+    partial  = { remainder_r, quotient_r[31:30] };
+    divisor1 = { 2'b0, divisor_r };
+    divisor2 = { 1'b0, divisor_r, 1'b0 };
+    divisor3 = divisor1 + divisor2;
+
+    priority if (partial >= divisor3) begin
+        digit        = 2'd3;
+        partial_next = 32'(partial - divisor3);
+    end else if (partial >= divisor2) begin
+        digit        = 2'd2;
+        partial_next = 32'(partial - divisor2);
+    end else if (partial >= divisor1) begin
+        digit        = 2'd1;
+        partial_next = 32'(partial - divisor1);
+    end else begin
+        digit        = 2'd0;
+        partial_next = partial[31:0];
+    end
+end
+
+
+//
+// Sequencing
+//
+
+always_ff @(posedge clk_i) begin
+    unique case (state_r)
+    S_IDLE:
+        if (valid_i) begin
+            if (divide) begin
+                quotient_r  <= dividend;
+                remainder_r <= 32'b0;
+                divisor_r   <= divisor;
+                step_r      <= '0;
+                state_r     <= S_DIVIDE;
+            end else begin
+                product_r   <= mul_op1 * mul_op2;
+                state_r     <= S_DONE;
+            end
+        end
+    S_DIVIDE:
+        begin
+            quotient_r  <= { quotient_r[29:0], digit };
+            remainder_r <= partial_next;
+            step_r      <= step_r + 1'b1;
+            if (step_r == '1)
+                state_r <= S_DONE;
+        end
+    S_DONE:
+        if (ready_i)
+            state_r <= S_IDLE;
+    default:
+        state_r <= S_IDLE;
+    endcase
+end
+
+
+//
+// Result
+//
+
+always_comb begin
+    done_async_o = (state_r == S_DONE);
+
+    // signed results take the sign of the true quotient (unless dividing by zero, which gives all ones) or the dividend
+    unique case (f3)
+    F3_MUL:    result_async_o = product_r[31:0];
+    F3_MULH,
+    F3_MULHSU,
+    F3_MULHU:  result_async_o = product_r[63:32];
+    F3_DIV:    result_async_o = (op1_i[31] != op2_i[31] && op2_i != 32'b0) ? -quotient_r : quotient_r;
+    F3_DIVU:   result_async_o = quotient_r;
+    F3_REM:    result_async_o = op1_i[31] ? -remainder_r : remainder_r;
+    F3_REMU:   result_async_o = remainder_r;
+    endcase
+end
+
+endmodule
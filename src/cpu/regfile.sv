@@ -5,8 +5,8 @@
 /// Register File (32 x 32-bit)
 ///
 /// Specs:
-/// 2-port async read
-/// 1-port sync write
+/// 4-port async read (ports C and D serve the second issue lane)
+/// 2-port sync write (port B is the younger instruction, so it wins a collision)
 ///
 
 module regfile
@@ -24,10 +24,23 @@ module regfile
         input  wire regaddr_t read2_addr_i,       // Read Address
         output      word_t    read2_data_async_o, // Data Output
 
-        // write port
+        // read port C
+        input  wire regaddr_t read3_addr_i,       // Read Address
+        output      word_t    read3_data_async_o, // Data Output
+
+        // read port D
+        input  wire regaddr_t read4_addr_i,       // Read Address
+        output      word_t    read4_data_async_o, // Data Output
+
+        // write port A
         input  wire logic     write_enable_i,     // Write Enable
         input  wire regaddr_t write_addr_i,       // Write Address
-        input  wire word_t    write_data_i        // Write Data
+        input  wire word_t    write_data_i,       // Write Data
+
+        // write port B
+        input  wire logic     write2_enable_i,    // Write Enable
+        input  wire regaddr_t write2_addr_i,      // Write Address
+        input  wire word_t    write2_data_i       // Write Data
     );
 
 // Memory
@@ -37,13 +50,18 @@ word_t mem_r [31:0] = '{ default: '0 };
 always_comb begin
     read1_data_async_o = mem_r[read1_addr_i];
     read2_data_async_o = mem_r[read2_addr_i];
+    read3_data_async_o = mem_r[read3_addr_i];
+    read4_data_async_o = mem_r[read4_addr_i];
 end
 
-// Write Port
+// Write Ports
 always_ff @(posedge clk_i) begin
     if (write_enable_i && write_addr_i != 5'b00000) begin
         mem_r[write_addr_i] <= write_data_i;
     end
+    if (write2_enable_i && write2_addr_i != 5'b00000) begin
+        mem_r[write2_addr_i] <= write2_data_i;
+    end
 end
 
 endmodule
@@ -0,0 +1,102 @@
+`timescale 1ns / 1ps
+`default_nettype none
+
+///
+/// Risc-V CPU Return Address Stack
+///
+/// Specs:
+/// Circular stack of return addresses (overflow overwrites the oldest entry)
+/// Speculative copy updated by fetch, committed copy updated by register read
+/// Speculative copy restored from the committed copy when fetch is redirected
+///
+
+module return_address_stack
+    // Import Constants
+    import common::*;
+    import cpu_common::*;
+    #(
+        parameter int unsigned RAS_BITS = 3            // log2(return address stack entries)
+    )
+    (
+        input  wire logic       clk_i,                 // clock
+
+        // speculative port
+        input  wire logic       push_i,                // fetched a call
+        input  wire logic       pop_i,                 // fetched a return
+        input  wire word_t      push_addr_i,           // return address of the fetched call
+        output      logic       valid_async_o,         // stack is not empty
+        output      word_t      top_async_o,           // predicted return address
+
+        // committed port
+        input  wire bp_update_t update_i,              // resolved control transfer
+        input  wire logic       recover_i              // fetch redirected, discard speculative updates
+    );
+
+
+//
+// Stacks
+//
+
+localparam int unsigned RAS_DEPTH = 2**RAS_BITS;
+
+typedef logic [RAS_BITS-1:0] ras_ptr_t;
+typedef logic [RAS_BITS:0]   ras_count_t;
+
+typedef struct packed {
+    word_t [RAS_DEPTH-1:0] entries;  // return addresses
+    ras_ptr_t              ptr;      // top of stack
+    ras_count_t            count;    // valid entries, saturating at RAS_DEPTH
+} ras_t;
+
+ras_t spec_r   = '0;
+ras_t commit_r = '0;
+
+function automatic ras_t ras_update(ras_t ras, logic push, logic pop, word_t addr);
+    ras_t result = ras;
+
+    // pop before push, so an instruction doing both replaces the top entry
+    if (pop && result.count != '0) begin
+        result.ptr   = result.ptr - 1'b1;
+        result.count = result.count - 1'b1;
+    end
+
+    if (push) begin
+        result.ptr                 = result.ptr + 1'b1;
+        result.entries[result.ptr] = addr;
+        if (result.count != ras_count_t'(RAS_DEPTH))
+            result.count = result.count + 1'b1;
+    end
+
+    return result;
+endfunction
+
+
+//
+// Prediction
+//
+
+always_comb begin
+    valid_async_o = spec_r.count != '0;
+    top_async_o   = spec_r.entries[spec_r.ptr];
+end
+
+
+//
+// Update
+//
+
+ras_t commit_next;
+always_comb begin
+    commit_next = update_i.valid ? ras_update(commit_r, update_i.call, update_i.ret, update_i.link) : commit_r;
+end
+
+always_ff @(posedge clk_i) begin
+    commit_r <= commit_next;
+
+    if (recover_i)
+        spec_r <= commit_next;
+    else
+        spec_r <= ras_update(spec_r, push_i, pop_i, push_addr_i);
+end
+
+endmodule
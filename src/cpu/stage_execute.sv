@@ -4,6 +4,11 @@
 ///
 /// Risc-V CPU Execution Stage
 ///
+/// Specs:
+/// Holds its output while the MA stage is waiting on memory
+/// Outputs bubbles while a multiply/divide is in progress
+/// Second lane instructions (DUAL_ISSUE) only use the second ALU, and move with the first lane
+///
 
 module stage_execute
     // Import Constants
@@ -28,9 +33,18 @@ module stage_execute
         input  wire word_t     wb_data_i,        // write-back data
         input  wire logic      wb_ready_i,       // write-back ready
         input  wire logic      wb_valid_i,       // write-back valid
+        input  wire word_t     alu2_op1_i,       // second lane ALU operand 1
+        input  wire word_t     alu2_op2_i,       // second lane ALU operand 2
+        input  wire alu_mode_t alu2_mode_i,      // second lane ALU mode
+        input  wire regaddr_t  wb2_addr_i,       // second lane write-back address
+        input  wire logic      wb2_valid_i,      // second lane write-back valid
+
+        // async input
+        input  wire logic      ready_i,          // is the MA stage ready to accept input
 
         // status output
         output      logic      empty_async_o,    // stage empty
+        output      logic      ready_async_o,    // stage ready for new inputs
 
         // pipeline output
         output wire word_t     pc_o,             // program counter
@@ -43,7 +57,10 @@ module stage_execute
         output wire regaddr_t  wb_addr_o,        // write-back address
         output wire word_t     wb_data_o,        // write-back data
         output wire logic      wb_ready_o,       // write-back data ready
-        output wire logic      wb_valid_o        // write-back valid
+        output wire logic      wb_valid_o,       // write-back valid
+        output wire regaddr_t  wb2_addr_o,       // second lane write-back address
+        output wire word_t     wb2_data_o,       // second lane write-back data
+        output wire logic      wb2_valid_o       // second lane write-back valid
     );
 
 initial start_logging();
@@ -62,6 +79,40 @@ alu alu (
     .alu_result_async_o (alu_result)
 );
 
+wire word_t alu2_result;
+
+alu alu2 (
+    .alu_mode_i         (alu2_mode_i),
+    .alu_op1_i          (alu2_op1_i),
+    .alu_op2_i          (alu2_op2_i),
+    .alu_result_async_o (alu2_result)
+);
+
+
+//
+// Multiply/Divide Unit
+//
+
+logic       muldiv_valid;
+wire logic  muldiv_done;
+wire word_t muldiv_result;
+
+always_comb muldiv_valid = is_muldiv(alu_mode_i);
+
+muldiv muldiv (
+    .clk_i          (clk_i),
+    .valid_i        (muldiv_valid),
+    .f3_i           (alu_mode_i[2:0]),
+    .op1_i          (alu_op1_i),
+    .op2_i          (alu_op2_i),
+    .ready_i        (ready_i),
+    .done_async_o   (muldiv_done),
+    .result_async_o (muldiv_result)
+);
+
+word_t result;
+always_comb result = muldiv_valid ? muldiv_result : alu_result;
+
 
 //
 // Status Outputs
@@ -69,6 +120,7 @@ alu alu (
 
 always_comb begin
     empty_async_o = pc_i == NOP_PC;
+    ready_async_o = ready_i && (!muldiv_valid || muldiv_done);
 end
 
 
@@ -109,18 +161,50 @@ assign    wb_ready_o = wb_ready_r;
 logic     wb_valid_r = NOP_WB_VALID;
 assign    wb_valid_o = wb_valid_r;
 
+regaddr_t wb2_addr_r  = NOP_WB_ADDR;
+assign    wb2_addr_o  = wb2_addr_r;
+
+word_t    wb2_data_r  = 32'b0;
+assign    wb2_data_o  = wb2_data_r;
+
+logic     wb2_valid_r = NOP_WB_VALID;
+assign    wb2_valid_o = wb2_valid_r;
+
 always_ff @(posedge clk_i) begin
-    pc_r       <= pc_i;
-    ir_r       <= ir_i;
-    ma_addr_r  <= (ma_mode_i == MA_X) ? 32'b0 : alu_result;
-    ma_mode_r  <= ma_mode_i;
-    ma_size_r  <= ma_size_i;
-    ma_data_r  <= ma_data_i;
-    wb_src_r   <= wb_src_i;
-    wb_addr_r  <= wb_addr_i;
-    wb_data_r  <= (wb_src_i == WB_SRC_ALU) ? alu_result : wb_data_i;
-    wb_ready_r <= (wb_src_i == WB_SRC_ALU) ? 1'b1       : wb_ready_i;
-    wb_valid_r <= wb_valid_i;
+    if (!ready_i) begin
+        // MA is holding its instruction, so hold ours
+    end else if (!ready_async_o) begin
+        // multiply/divide still in progress, output a bubble
+        pc_r       <= NOP_PC;
+        ir_r       <= NOP_IR;
+        ma_addr_r  <= 32'b0;
+        ma_mode_r  <= NOP_MA_MODE;
+        ma_size_r  <= NOP_MA_SIZE;
+        ma_data_r  <= 32'b0;
+        wb_src_r   <= NOP_WB_SRC;
+        wb_addr_r  <= NOP_WB_ADDR;
+        wb_data_r  <= 32'b0;
+        wb_ready_r <= 1'b0;
+        wb_valid_r <= NOP_WB_VALID;
+        wb2_addr_r  <= NOP_WB_ADDR;
+        wb2_data_r  <= 32'b0;
+        wb2_valid_r <= NOP_WB_VALID;
+    end else begin
+        pc_r       <= pc_i;
+        ir_r       <= ir_i;
+        ma_addr_r  <= (ma_mode_i == MA_X) ? 32'b0 : result;
+        ma_mode_r  <= ma_mode_i;
+        ma_size_r  <= ma_size_i;
+        ma_data_r  <= ma_data_i;
+        wb_src_r   <= wb_src_i;
+        wb_addr_r  <= wb_addr_i;
+        wb_data_r  <= (wb_src_i == WB_SRC_ALU) ? result : wb_data_i;
+        wb_ready_r <= (wb_src_i == WB_SRC_ALU) ? 1'b1   : wb_ready_i;
+        wb_valid_r <= wb_valid_i;
+        wb2_addr_r  <= wb2_addr_i;
+        wb2_data_r  <= alu2_result;
+        wb2_valid_r <= wb2_valid_i;
+    end
 
     `log_strobe(("{ \"stage\": \"EX\", \"pc\": \"%0d\", \"ex_wb_addr\": \"%0d\", \"ex_wb_data\": \"%0d\", \"ex_wb_valid\": \"%0d\" }", pc_i, wb_addr_o, wb_data_o, wb_valid_o));
     `log_strobe(("{ \"stage\": \"EX\", \"pc\": \"%0d\", \"ir\": \"%0d\", \"ma_addr\": \"%0d\", \"ma_mode\": \"%0d\", \"ma_size\": \"%0d\", \"ma_data\": \"%0d\", \"wb_src\": \"%0d\", \"wb_data\": \"%0d\", \"wb_valid\": \"%0d\" }", pc_r, ir_r, ma_addr_r, ma_mode_r, ma_size_r, ma_data_r, wb_src_r, wb_data_r, wb_valid_r));
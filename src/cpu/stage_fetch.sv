@@ -4,6 +4,14 @@
 ///
 /// Risc-V CPU Instruction Fetch Stage
 ///
+/// Specs:
+/// Fetched instructions pass to ID through a skid buffer, so the ID stage's ready signal
+/// is registered before it steers instruction memory
+/// Each fetch also sees the following word, so an instruction that straddles two words
+/// after a jump to an unaligned address is output without a bubble
+/// Up to two sequential instructions are output per cycle, the second only when neither is
+/// predicted and it isn't a control transfer (only the first is looked up in the predictor)
+///
 
 module stage_fetch
     // Import Constants
@@ -18,16 +26,28 @@ module stage_fetch
         // instruction memory
         output wire word_t imem_addr_o, // memory address
         input  wire word_t imem_data_i, // data
+        input  wire logic  imem_valid_i, // data valid (stall and re-request the address if not)
+        input  wire word_t imem_data2_i, // data of the following word
+        input  wire logic  imem_valid2_i, // following data valid
+        output      logic  imem_taken_o, // imem_data_i was consumed this cycle
 
         // async input
         input  wire word_t jmp_addr_i,  // jump address
         input  wire logic  jmp_valid_i, // whether or not jump address is valid
         input  wire logic  ready_i,     // is the ID stage ready to accept input
 
+        // branch predictor training
+        input  wire bp_update_t bp_update_i, // control transfer resolved by the RR stage
+
         // pipeline output
         output wire word_t pc_o,        // program counter
         output wire word_t ir_o,        // instruction register
-        output wire word_t pc_next_o    // next program counter
+        output wire word_t pc_next_o,   // next program counter
+        output wire word_t pred_pc_o,   // predicted program counter of the following instruction
+        output wire word_t pc2_o,       // program counter of the second instruction (NOP_PC if none)
+        output wire word_t ir2_o,       // instruction register of the second instruction
+        output wire word_t pc_next2_o,  // next program counter of the second instruction
+        output wire word_t pred_pc2_o   // predicted program counter after the second instruction (never taken)
     );
 
 initial start_logging();
@@ -44,6 +64,63 @@ always_ff @(posedge clk_i) begin
 end
 
 
+//
+// Branch Prediction
+//
+
+// branch target buffer prediction for the instruction being fetched
+logic  btb_predict;
+word_t btb_addr;
+
+branch_predictor branch_predictor (
+    .clk_i           (clk_i),
+    .pc_i            (pc_next_r),
+    .predict_async_o (btb_predict),
+    .target_async_o  (btb_addr),
+    .update_i        (bp_update_i)
+);
+
+// return address stack, updated as calls and returns are output
+logic  emit;
+logic  ras_valid;
+word_t ras_addr;
+
+return_address_stack return_address_stack (
+    .clk_i         (clk_i),
+    .push_i        (emit && is_call(decompressed_ir)),
+    .pop_i         (emit && is_return(decompressed_ir)),
+    .push_addr_i   (fetched.pc_next),
+    .valid_async_o (ras_valid),
+    .top_async_o   (ras_addr),
+    .update_i      (bp_update_i),
+    .recover_i     (jmp_valid_i)
+);
+
+// direct jumps (jal, c.j, c.jal) carry their target, so predecode them rather than predict them
+logic  direct_jump;
+word_t direct_addr;
+always_comb begin
+    direct_jump = decompressed_ir[6:0] == OP_JAL;
+    direct_addr = pc_next_r + { {12{decompressed_ir[31]}}, decompressed_ir[19:12], decompressed_ir[20], decompressed_ir[30:25], decompressed_ir[24:21], 1'b0 };
+end
+
+// direct jumps go to their target, returns follow the stack, everything else the branch target buffer
+logic  predict;
+word_t predict_addr;
+always_comb begin
+    priority if (direct_jump) begin
+        predict      = 1'b1;
+        predict_addr = direct_addr;
+    end else if (is_return(decompressed_ir) && ras_valid) begin
+        predict      = 1'b1;
+        predict_addr = ras_addr;
+    end else begin
+        predict      = btb_predict;
+        predict_addr = btb_addr;
+    end
+end
+
+
 //
 // State Machine
 //
@@ -69,36 +146,68 @@ logic stall;
 logic aligned_jump;
 logic unaligned_jump_1;
 logic unaligned_jump_2;
+logic land_compressed;
+logic land_straddling;
 logic stay_aligned;
 logic lose_alignment;
 logic stay_unaligned;
 logic gain_alignment;
+logic predicting;
+logic predicted_jump;
+logic predicted_unaligned_jump;
+logic sequential;
+logic double;
+logic double_aligned;
+logic double_unaligned;
 
-// edge determination
+// edge determination (jumps flush the output buffer, so they don't wait for room in it)
+// (anything consuming imem_data_i waits for it to be valid, stalling on the same address)
 always_comb begin
     waiting          = (state_r == S_STARTUP)         &&  first_cycle_r[0];
-    start_aligned    = (state_r == S_STARTUP)         && !first_cycle_r[0] && !compressed;
-    start_unaligned  = (state_r == S_STARTUP)         && !first_cycle_r[0] &&  compressed;
+    start_aligned    = (state_r == S_STARTUP)         && !first_cycle_r[0] &&  imem_valid_i && !compressed && !predict;
+    start_unaligned  = (state_r == S_STARTUP)         && !first_cycle_r[0] &&  imem_valid_i &&  compressed && !predict;
     halt             = (state_r == S_HALTED)          ||  halt_i;
-    stall            =                                   !halt_i && !ready_i;
-    aligned_jump     =                                   !halt_i &&  ready_i &&  jmp_valid_i && jmp_addr_i[1:0] == 2'b0;
-    unaligned_jump_1 =                                   !halt_i &&  ready_i &&  jmp_valid_i && jmp_addr_i[1:0] != 2'b0;
-    unaligned_jump_2 = (state_r == S_UNALIGNED_JUMP);
-    stay_aligned     = (state_r == S_ALIGNED)         && !halt_i &&  ready_i && !jmp_valid_i && !compressed;
-    lose_alignment   = (state_r == S_ALIGNED)         && !halt_i &&  ready_i && !jmp_valid_i &&  compressed;
-    stay_unaligned   = (state_r == S_UNALIGNED)       && !halt_i &&  ready_i && !jmp_valid_i && !compressed;
-    gain_alignment   = (state_r == S_UNALIGNED)       && !halt_i &&  ready_i && !jmp_valid_i &&  compressed;
+    stall            = !waiting                       && !halt_i && !jmp_valid_i && (!ready || !imem_valid_i);
+    aligned_jump     =                                   !halt_i &&            jmp_valid_i && jmp_addr_i[1:0] == 2'b0;
+    unaligned_jump_1 =                                   !halt_i &&            jmp_valid_i && jmp_addr_i[1:0] != 2'b0;
+    unaligned_jump_2 = (state_r == S_UNALIGNED_JUMP)  && !halt_i &&  ready && !jmp_valid_i && imem_valid_i && !compressed && !imem_valid2_i;
+    land_compressed  = (state_r == S_UNALIGNED_JUMP)  && !halt_i &&  ready && !jmp_valid_i && imem_valid_i &&  compressed && !predict;
+    land_straddling  = (state_r == S_UNALIGNED_JUMP)  && !halt_i &&  ready && !jmp_valid_i && imem_valid_i && !compressed &&  imem_valid2_i && !predict;
+
+    // a second instruction follows the first when it is entirely in the fetched words and not a control transfer
+    sequential       = (state_r == S_ALIGNED || state_r == S_UNALIGNED) && !halt_i && ready && !jmp_valid_i && imem_valid_i && !predict;
+    double           = sequential && second_whole && !(second_ir[6:0] inside { OP_JAL, OP_JALR, OP_BRANCH });
+    double_aligned   = double && !second_used[0];
+    double_unaligned = double &&  second_used[0];
+
+    stay_aligned     = (state_r == S_ALIGNED)         && !halt_i &&  ready && !jmp_valid_i && imem_valid_i && !compressed && !predict && !double;
+    lose_alignment   = (state_r == S_ALIGNED)         && !halt_i &&  ready && !jmp_valid_i && imem_valid_i &&  compressed && !predict && !double;
+    stay_unaligned   = (state_r == S_UNALIGNED)       && !halt_i &&  ready && !jmp_valid_i && imem_valid_i && !compressed && !predict && !double;
+    gain_alignment   = (state_r == S_UNALIGNED)       && !halt_i &&  ready && !jmp_valid_i && imem_valid_i &&  compressed && !predict && !double;
+
+    // an instruction predicted taken is output as usual, but fetch continues from its predicted target
+    // (after a jump to an unaligned address, only once the whole instruction is in hand)
+    predicting       = predict && imem_valid_i && (((state_r == S_STARTUP) && !first_cycle_r[0]) || ((state_r == S_ALIGNED || state_r == S_UNALIGNED) && !halt_i && ready && !jmp_valid_i)
+                                                || ((state_r == S_UNALIGNED_JUMP) && !halt_i && ready && !jmp_valid_i && (compressed || imem_valid2_i)));
+    predicted_jump           = predicting && predict_addr[1:0] == 2'b0;
+    predicted_unaligned_jump = predicting && predict_addr[1:0] != 2'b0;
+
+    // an instruction is passed to ID
+    emit             = start_aligned || start_unaligned || stay_aligned || lose_alignment || gain_alignment || stay_unaligned || land_compressed || land_straddling || predicting || double;
+
+    // the fetched word is used (the first half of an unaligned jump target is used without emitting)
+    imem_taken_o     = emit || unaligned_jump_2;
 end
 
 // next state determination
 always_comb begin
     unique if (waiting)
         state_next = S_STARTUP;
-    else if (start_aligned || stay_aligned || gain_alignment || aligned_jump)
+    else if (start_aligned || stay_aligned || gain_alignment || land_compressed || aligned_jump || predicted_jump || double_aligned)
         state_next = S_ALIGNED;
-    else if (start_unaligned || stay_unaligned || lose_alignment || unaligned_jump_2)
+    else if (start_unaligned || stay_unaligned || lose_alignment || land_straddling || unaligned_jump_2 || double_unaligned)
         state_next = S_UNALIGNED;
-    else if (unaligned_jump_1)
+    else if (unaligned_jump_1 || predicted_unaligned_jump)
         state_next = S_UNALIGNED_JUMP;
     else if (halt)
         state_next = S_HALTED;
@@ -120,7 +229,8 @@ always_comb begin
     S_STARTUP:   compressed_ir = imem_data_i;
     S_ALIGNED:   compressed_ir = imem_data_i;
     S_UNALIGNED: compressed_ir = { imem_data_i[15:0], saved_ir_r };
-    S_UNALIGNED_JUMP,
+    S_UNALIGNED_JUMP:
+                 compressed_ir = { imem_data2_i[15:0], imem_data_i[31:16] };
     S_HALTED:    compressed_ir = NOP_IR;
     default:     compressed_ir = NOP_IR;
     endcase
@@ -133,6 +243,38 @@ decompressor decompressor (
     .compressed_o (compressed)
 );
 
+// the second instruction starts where the first ends: in the upper half of the fetched word,
+// at the following word, or (when the first only finishes the saved half) at the fetched word
+logic  second_upper;
+word_t second_compressed_ir;
+always_comb begin
+    second_upper = (state_r == S_ALIGNED) == compressed;
+
+    if (second_upper)
+        second_compressed_ir = { imem_data2_i[15:0], imem_data_i[31:16] };
+    else if (state_r == S_ALIGNED)
+        second_compressed_ir = imem_data2_i;
+    else
+        second_compressed_ir = imem_data_i;
+end
+
+word_t second_ir;
+logic  second_compressed;
+decompressor second_decompressor (
+    .ir_i         (second_compressed_ir),
+    .ir_o         (second_ir),
+    .compressed_o (second_compressed)
+);
+
+// halfwords used by both instructions, counted from the start of the fetched word
+// (the following word is only needed if the second instruction reaches into it)
+logic [2:0] second_used;
+logic       second_whole;
+always_comb begin
+    second_used  = (compressed ? 3'd1 : 3'd2) + (second_compressed ? 3'd1 : 3'd2) - ((state_r == S_UNALIGNED) ? 3'd1 : 3'd0);
+    second_whole = imem_valid2_i || (second_upper ? second_compressed : (state_r == S_UNALIGNED));
+end
+
 // take transition actions
 word_t imem_addr_r = '0;
 word_t imem_addr;
@@ -143,46 +285,38 @@ always_comb begin
         imem_addr = 32'd0;
     else if (stall || gain_alignment)
         imem_addr = imem_addr_r;
-    else if (start_aligned || start_unaligned || stay_aligned || stay_unaligned || lose_alignment || unaligned_jump_2)
+    else if (start_aligned || start_unaligned || stay_aligned || stay_unaligned || lose_alignment || land_compressed || unaligned_jump_2)
         imem_addr = imem_addr_r + 4;
+    else if (land_straddling)
+        imem_addr = imem_addr_r + 8;
+    else if (double)
+        imem_addr = imem_addr_r + ((second_used > 3'd2) ? 32'd8 : 32'd4);
     else if (aligned_jump || unaligned_jump_1)
         imem_addr = { jmp_addr_i[31:2], 2'b00 };
+    else if (predicted_jump || predicted_unaligned_jump)
+        imem_addr = { predict_addr[31:2], 2'b00 };
 end
 always_ff @(posedge clk_i) begin
     imem_addr_r <= imem_addr;
 end
 
-word_t ir_r = NOP_IR;
-assign ir_o = ir_r;
-always_ff @(posedge clk_i) begin
-    if (waiting || halt || aligned_jump || unaligned_jump_1 || unaligned_jump_2)
-        ir_r <= NOP_IR;
-    else if (start_aligned || start_unaligned || stay_aligned || lose_alignment || gain_alignment || stay_unaligned)
-        ir_r <= decompressed_ir;
-end
-
-word_t pc_r = NOP_PC;
-assign pc_o = pc_r;
-always_ff @(posedge clk_i) begin
-    if (waiting || halt || aligned_jump || unaligned_jump_1 || unaligned_jump_2)
-        pc_r <= NOP_PC;
-    else if (start_aligned || start_unaligned || stay_aligned || lose_alignment || gain_alignment || stay_unaligned)
-        pc_r <= pc_next_r;
-end
-
+// the address being fetched, which follows the output instruction unless a jump intervenes
 word_t pc_next_r = NOP_PC;
-assign pc_next_o = pc_next_r;
 always_ff @(posedge clk_i) begin
     if (waiting)
         pc_next_r <= '0;
-    else if (start_unaligned || gain_alignment || lose_alignment)
+    else if (predicted_jump || predicted_unaligned_jump)
+        pc_next_r <= predict_addr;
+    else if (start_unaligned || gain_alignment || lose_alignment || land_compressed)
         pc_next_r <= pc_next_r + 2;
-    else if (start_aligned || stay_aligned || stay_unaligned)
+    else if (start_aligned || stay_aligned || stay_unaligned || land_straddling)
         pc_next_r <= pc_next_r + 4;
     else if (unaligned_jump_1 || aligned_jump)
         pc_next_r <= jmp_addr_i;
     else if (unaligned_jump_2)
         pc_next_r <= jmp_addr_r;
+    else if (double)
+        pc_next_r <= fetched2.pc_next;
     else if (halt)
         pc_next_r <= NOP_PC;
 end
@@ -192,15 +326,82 @@ word_t jmp_addr_r = '0;
 always_ff @(posedge clk_i) begin
     if (unaligned_jump_1)
         jmp_addr_r <= jmp_addr_i;
+    else if (predicted_unaligned_jump)
+        jmp_addr_r <= predict_addr;
 end
 
 // save unused portion of IR if needed
 logic [15:0] saved_ir_r = '0;
 always_ff @(posedge clk_i) begin
-    if (start_unaligned || lose_alignment || stay_unaligned || unaligned_jump_2)
+    if (start_unaligned || lose_alignment || stay_unaligned || unaligned_jump_2 || (double_unaligned && second_used == 3'd1))
         saved_ir_r <= imem_data_i[31:16];
+    else if (land_straddling || (double_unaligned && second_used == 3'd3))
+        saved_ir_r <= imem_data2_i[31:16];
 end
 
+
+//
+// Output Buffer
+//
+
+typedef struct packed {
+    word_t pc;       // program counter
+    word_t ir;       // instruction register
+    word_t pc_next;  // sequential successor
+    word_t pred_pc;  // predicted successor
+} fetched_t;
+
+fetched_t fetched;
+always_comb begin
+    fetched.pc      = pc_next_r;
+    fetched.ir      = decompressed_ir;
+    fetched.pc_next = pc_next_r + (compressed ? 32'd2 : 32'd4);
+    fetched.pred_pc = predicting ? predict_addr : fetched.pc_next;
+end
+
+// the second instruction is a bubble when only one was fetched
+fetched_t fetched2;
+always_comb begin
+    fetched2.pc      = double ? fetched.pc_next : NOP_PC;
+    fetched2.ir      = double ? second_ir       : NOP_IR;
+    fetched2.pc_next = fetched.pc_next + (second_compressed ? 32'd2 : 32'd4);
+    fetched2.pred_pc = fetched2.pc_next;
+end
+
+// each entry holds both instructions of a fetch
+typedef struct packed {
+    fetched_t second;
+    fetched_t first;
+} fetch_pair_t;
+
+// registered ready, so ID's stall logic doesn't reach the fetch address
+logic        ready;
+logic        output_valid;
+fetch_pair_t output_data;
+
+skid_buffer #(
+    .WORD_WIDTH    ($bits(fetch_pair_t))
+) output_buffer (
+    .clk_i         (clk_i),
+    .flush_i       (jmp_valid_i || halt),
+    .write_ready_o (ready),
+    .write_valid_i (emit),
+    .write_data_i  ({ fetched2, fetched }),
+    .read_ready_i  (ready_i),
+    .read_valid_o  (output_valid),
+    .read_data_o   (output_data)
+);
+
+// nothing to decode is a bubble
+assign pc_o       = output_valid ? output_data.first.pc  : NOP_PC;
+assign ir_o       = output_valid ? output_data.first.ir  : NOP_IR;
+assign pc_next_o  = output_data.first.pc_next;
+assign pred_pc_o  = output_data.first.pred_pc;
+assign pc2_o      = output_valid ? output_data.second.pc : NOP_PC;
+assign ir2_o      = output_valid ? output_data.second.ir : NOP_IR;
+assign pc_next2_o = output_data.second.pc_next;
+assign pred_pc2_o = output_data.second.pred_pc;
+
 always_ff @(posedge clk_i) begin
     `log_strobe(("{ \"stage\": \"IF\", \"pc\": \"%0d\", \"ir\": \"%0d\" }", pc_o, ir_o));
 end
@@ -4,6 +4,13 @@
 ///
 /// Risc-V CPU Memory Access Stage
 ///
+/// Specs:
+/// Holds its input (and outputs bubbles) until the store buffer accepts the access
+/// Atomics (A extension): lr reserves its word, sc stores only while the reservation holds,
+/// and amos read in one access and write the combined value in the next
+/// Misaligned loads and stores that cross a word boundary are split into two accesses
+/// (a split load's first word goes to WB as its write-back data, to be merged with the second)
+///
 
 module stage_memory
     // Import Constants
@@ -19,6 +26,9 @@ module stage_memory
         output      logic       dmem_read_enable_o, // read enable
         output      word_t      dmem_write_data_o,  // write data
         output      logic [3:0] dmem_write_mask_o,  // write enable
+        output      logic       dmem_fence_o,       // wait for buffered stores
+        input  wire logic       dmem_ready_i,       // access accepted
+        input  wire word_t      dmem_read_data_i,   // read data of the previous cycle's accepted access
 
         // pipeline input
         input  wire word_t      pc_i,               // program counter
@@ -32,9 +42,13 @@ module stage_memory
         input  wire word_t      wb_data_i,          // write-back data
         input  wire logic       wb_ready_i,         // write-back ready
         input  wire logic       wb_valid_i,         // write-back valid
+        input  wire regaddr_t   wb2_addr_i,         // second lane write-back address
+        input  wire word_t      wb2_data_i,         // second lane write-back data
+        input  wire logic       wb2_valid_i,        // second lane write-back valid
 
         // status output
         output      logic       empty_async_o,      // stage empty
+        output      logic       ready_async_o,      // stage ready for new inputs
 
         // pipeline output
         output wire word_t      pc_o,               // program counter
@@ -45,40 +59,116 @@ module stage_memory
         output      regaddr_t   wb_addr_o,          // write-back address
         output      word_t      wb_data_o,          // write-back data
         output      logic       wb_ready_o,         // write-back ready
-        output      logic       wb_valid_o          // write-back valid
+        output      logic       wb_valid_o,         // write-back valid
+        output      regaddr_t   wb2_addr_o,         // second lane write-back address
+        output      word_t      wb2_data_o,         // second lane write-back data
+        output      logic       wb2_valid_o         // second lane write-back valid
     );
 
 initial start_logging();
 final stop_logging();
 
+//
+// Atomics
+//
+
+funct5_t amo_op;
+logic    lr;          // load reserved
+logic    sc;          // store conditional
+logic    amo;         // read-modify-write
+always_comb begin
+    amo_op = ir_i[31:27];
+    lr     = (ma_mode_i == MA_AMO) && (amo_op == F5_LR);
+    sc     = (ma_mode_i == MA_AMO) && (amo_op == F5_SC);
+    amo    = (ma_mode_i == MA_AMO) && !lr && !sc;
+end
+
+// any store to the reserved word breaks the reservation, so an interrupt handler touching it fails the sc
+word_t reserved_addr_r = 32'b0;
+logic  reserved_r      = 1'b0;
+
+logic  sc_success;
+always_comb sc_success = sc && reserved_r && (reserved_addr_r == { ma_addr_i[31:2], 2'b0 });
+
+
+//
+// Two Access Operations
+//
+
+// amos read, then write the same word, and misaligned loads and stores that cross a word boundary
+// access this word, then the next (atomics are always aligned, RR traps them otherwise)
+logic  split;
+logic  two_access;
+always_comb begin
+    split      = (ma_mode_i == MA_LOAD || ma_mode_i == MA_STORE) && crosses_word(ma_size_i, ma_addr_i[1:0]);
+    two_access = amo || split;
+end
+
+// the stage holds from the first access being accepted until the second is
+logic  second_r     = 1'b0;   // first access accepted, second pending
+logic  fresh_r      = 1'b0;   // first access's read data arrives this cycle
+word_t first_data_r = 32'b0;  // first access's read data, kept while the second waits
+
+word_t first_data;
+always_comb first_data = fresh_r ? dmem_read_data_i : first_data_r;
+
+word_t amo_new;
+always_comb begin
+    unique case (amo_op)
+    F5_AMOSWAP: amo_new = ma_data_i;
+    F5_AMOADD:  amo_new = first_data + ma_data_i;
+    F5_AMOXOR:  amo_new = first_data ^ ma_data_i;
+    F5_AMOAND:  amo_new = first_data & ma_data_i;
+    F5_AMOOR:   amo_new = first_data | ma_data_i;
+    F5_AMOMIN:  amo_new = (signed'(first_data) < signed'(ma_data_i)) ? first_data : ma_data_i;
+    F5_AMOMAX:  amo_new = (signed'(first_data) < signed'(ma_data_i)) ? ma_data_i : first_data;
+    F5_AMOMINU: amo_new = (        first_data  <         ma_data_i)  ? first_data : ma_data_i;
+    F5_AMOMAXU: amo_new = (        first_data  <         ma_data_i)  ? ma_data_i : first_data;
+    default:    amo_new = ma_data_i;
+    endcase
+end
+
+
 //
 // Memory Signals
 //
 
+// byte lanes and data of the access, across this word and the next
+logic [7:0]  lanes;
+logic [63:0] lane_data;
+
 always_comb begin
-    dmem_addr_o        = { ma_addr_i[31:2], 2'b0 };
-    dmem_read_enable_o = (ma_mode_i == MA_LOAD);
-    dmem_write_mask_o  = 4'b0000;
+    unique case (ma_size_i)
+    MA_SIZE_B,
+    MA_SIZE_BU: lanes = 8'b00000001 << ma_addr_i[1:0];
+    MA_SIZE_H,
+    MA_SIZE_HU: lanes = 8'b00000011 << ma_addr_i[1:0];
+    default:    lanes = 8'b00001111 << ma_addr_i[1:0];
+    endcase
 
     // shift data left based on address lower bits
     unique case (ma_addr_i[1:0])
-    2'b00: dmem_write_data_o = { ma_data_i[31:0]        };
-    2'b01: dmem_write_data_o = { ma_data_i[23:0],  8'b0 };
-    2'b10: dmem_write_data_o = { ma_data_i[15:0], 16'b0 };
-    2'b11: dmem_write_data_o = { ma_data_i[ 7:0], 24'b0 };
+    2'b00: lane_data = { 32'b0, ma_data_i        };
+    2'b01: lane_data = { 24'b0, ma_data_i,  8'b0 };
+    2'b10: lane_data = { 16'b0, ma_data_i, 16'b0 };
+    2'b11: lane_data = {  8'b0, ma_data_i, 24'b0 };
     endcase
+end
 
-    // choose write mask based on operation, size and alignment
-    unique case ({ ma_mode_i, ma_size_i, ma_addr_i[1:0] })
-    { MA_STORE, MA_SIZE_B, 2'b00 }: dmem_write_mask_o = 4'b0001;
-    { MA_STORE, MA_SIZE_B, 2'b01 }: dmem_write_mask_o = 4'b0010;
-    { MA_STORE, MA_SIZE_B, 2'b10 }: dmem_write_mask_o = 4'b0100;
-    { MA_STORE, MA_SIZE_B, 2'b11 }: dmem_write_mask_o = 4'b1000;
-    { MA_STORE, MA_SIZE_H, 2'b00 }: dmem_write_mask_o = 4'b0011;
-    { MA_STORE, MA_SIZE_H, 2'b10 }: dmem_write_mask_o = 4'b1100;
-    { MA_STORE, MA_SIZE_W, 2'b00 }: dmem_write_mask_o = 4'b1111;
-    default:                        dmem_write_mask_o = 4'b0000;
-    endcase
+always_comb begin
+    dmem_addr_o        = { ma_addr_i[31:2] + 30'(split && second_r), 2'b0 };
+    dmem_read_enable_o = (ma_mode_i == MA_LOAD) || lr || (amo && !second_r);
+    dmem_fence_o       = (ma_mode_i == MA_FENCE);
+
+    // the second access of a split store writes the lanes that spilled into the next word
+    dmem_write_data_o  = (split && second_r) ? lane_data[63:32] : lane_data[31:0];
+    dmem_write_mask_o  = (ma_mode_i != MA_STORE) ? 4'b0000 : (split && second_r) ? lanes[7:4] : lanes[3:0];
+
+    // atomics are word sized, a failed sc doesn't access memory at all
+    if (sc || amo) begin
+        dmem_write_data_o = sc ? ma_data_i : amo_new;
+        dmem_write_mask_o = (sc_success || (amo && second_r)) ? 4'b1111 : 4'b0000;
+    end
 
     `log_display(("{ \"stage\": \"MA\", \"pc\": \"%0d\", \"ma_mode\": \"%0d\", \"dmem_addr\": \"%0d\", \"dmem_write_data\": \"%0d\", \"dmem_write_mask\": \"%0d\" }", pc_i, ma_mode_i, dmem_addr_o, dmem_write_data_o, dmem_write_mask_o));
 end
@@ -91,6 +181,27 @@ end
 
 always_comb begin
     empty_async_o = pc_i == NOP_PC;
+    ready_async_o = dmem_ready_i && !(two_access && !second_r);
+end
+
+always_ff @(posedge clk_i) begin
+    fresh_r <= 1'b0;
+    if (two_access && dmem_ready_i) begin
+        second_r <= !second_r;
+        fresh_r  <= !second_r;
+    end
+
+    if (fresh_r)
+        first_data_r <= dmem_read_data_i;
+
+    if (lr && dmem_ready_i) begin
+        reserved_r      <= 1'b1;
+        reserved_addr_r <= dmem_addr_o;
+    end else if (sc && dmem_ready_i) begin
+        reserved_r      <= 1'b0;
+    end else if (dmem_ready_i && dmem_write_mask_o != 4'b0000 && dmem_addr_o == reserved_addr_r) begin
+        reserved_r      <= 1'b0;
+    end
 end
 
 
@@ -125,16 +236,44 @@ assign      wb_ready_o     = wb_ready_r;
 logic       wb_valid_r     = NOP_WB_VALID;
 assign      wb_valid_o     = wb_valid_r;
 
+regaddr_t   wb2_addr_r     = 5'b0;
+assign      wb2_addr_o     = wb2_addr_r;
+
+word_t      wb2_data_r     = 32'b0;
+assign      wb2_data_o     = wb2_data_r;
+
+logic       wb2_valid_r    = NOP_WB_VALID;
+assign      wb2_valid_o    = wb2_valid_r;
+
 always_ff @(posedge clk_i) begin
-    pc_r           <= pc_i;
-    ir_r           <= ir_i;
-    load_r         <= dmem_read_enable_o;
-    ma_size_r      <= (ma_mode_i == MA_X) ? MA_SIZE_W : ma_size_i;
-    ma_alignment_r <= ma_addr_i[1:0];
-    wb_addr_r      <= wb_addr_i;
-    wb_data_r      <= wb_data_i;
-    wb_ready_r     <= wb_ready_i;
-    wb_valid_r     <= wb_valid_i;
+    if (!ready_async_o) begin
+        // the access is still waiting on the cache (or on its second access), output a bubble
+        pc_r           <= NOP_PC;
+        ir_r           <= NOP_IR;
+        load_r         <= 1'b0;
+        ma_size_r      <= NOP_MA_SIZE;
+        ma_alignment_r <= 2'b00;
+        wb_addr_r      <= 5'b0;
+        wb_data_r      <= 32'b0;
+        wb_ready_r     <= 1'b0;
+        wb_valid_r     <= NOP_WB_VALID;
+        wb2_addr_r     <= 5'b0;
+        wb2_data_r     <= 32'b0;
+        wb2_valid_r    <= NOP_WB_VALID;
+    end else begin
+        pc_r           <= pc_i;
+        ir_r           <= ir_i;
+        load_r         <= dmem_read_enable_o;
+        ma_size_r      <= (ma_mode_i == MA_X) ? MA_SIZE_W : ma_size_i;
+        ma_alignment_r <= ma_addr_i[1:0];
+        wb_addr_r      <= wb_addr_i;
+        wb_data_r      <= sc ? { 31'b0, !sc_success } : two_access ? first_data : wb_data_i;
+        wb_ready_r     <= (sc || amo) ? 1'b1 : wb_ready_i;
+        wb_valid_r     <= wb_valid_i;
+        wb2_addr_r     <= wb2_addr_i;
+        wb2_data_r     <= wb2_data_i;
+        wb2_valid_r    <= wb2_valid_i;
+    end
 
     `log_strobe(("{ \"stage\": \"MA\", \"pc\": \"%0d\", \"ma_wb_addr\": \"%0d\", \"ma_wb_data\": \"%0d\", \"ma_wb_valid\": \"%0d\" }", pc_i, wb_addr_o, wb_data_o, wb_valid_o));
     `log_strobe(("{ \"stage\": \"MA\", \"pc\": \"%0d\", \"ir\": \"%0d\", \"load\": \"%0d\", \"ma_size\": \"%0d\", \"wb_data\": \"%0d\", \"wb_valid\": \"%0d\" }", pc_r, ir_r, load_r, ma_size_r, wb_data_r, wb_valid_r));
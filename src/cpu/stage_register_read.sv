@@ -0,0 +1,758 @@
+`timescale 1ns / 1ps
+`default_nettype none
+
+///
+/// Risc-V CPU Register Read Stage
+///
+/// Specs:
+/// Reads and bypasses operands, detecting data hazards
+/// Resolves branches and jumps, redirecting fetch on a misprediction
+/// Executes CSR and privileged instructions
+/// Issues fused instruction pairs as one operation
+/// Issues a paired ALU instruction in the second lane (DUAL_ISSUE)
+///
+
+module stage_register_read
+    // Import Constants
+    import common::*;
+    import cpu_common::*;
+    import csr_common::*;
+    import logging::*;
+    (
+        // cpu signals
+        input  wire logic      clk_i,               // clock
+        output      logic      halt_o,              // halt
+
+        // pipeline input
+        input  wire word_t     pc_i,                // program counter
+        input  wire word_t     ir_i,                // instruction register
+        input  wire word_t     pc_next_i,           // next program counter
+        input  wire word_t     pred_pc_i,           // predicted program counter of the following instruction
+        input  wire control_word_t cw_i,            // control word
+        input  wire word_t     ir2_i,               // instruction register of the second instruction (fused or paired)
+        input  wire fuse_t     fuse_i,              // macro-op fusion
+        input  wire word_t     pc2_i,               // program counter of the paired second instruction
+        input  wire control_word2_t cw2_i,          // control word of the paired second instruction
+        input  wire regaddr_t  ex_wb_addr_i,        // ex stage write-back address
+        input  wire word_t     ex_wb_data_i,        // ex stage write-back data
+        input  wire logic      ex_wb_ready_i,       // ex stage write-back data ready
+        input  wire logic      ex_wb_valid_i,       // ex stage write-back valid
+        input  wire regaddr_t  ex_wb2_addr_i,       // ex stage second lane write-back address
+        input  wire word_t     ex_wb2_data_i,       // ex stage second lane write-back data
+        input  wire logic      ex_wb2_valid_i,      // ex stage second lane write-back valid
+        input  wire logic      ex_empty_i,          // ex stage empty
+        input  wire logic      ex_ready_i,          // ex stage ready to accept input
+        input  wire regaddr_t  ma_wb_addr_i,        // ma stage write-back address
+        input  wire word_t     ma_wb_data_i,        // ma stage write-back data (including load results)
+        input  wire logic      ma_wb_valid_i,       // ma stage write-back valid
+        input  wire regaddr_t  ma_wb2_addr_i,       // ma stage second lane write-back address
+        input  wire word_t     ma_wb2_data_i,       // ma stage second lane write-back data
+        input  wire logic      ma_wb2_valid_i,      // ma stage second lane write-back valid
+        input  wire logic      ma_empty_i,          // ma stage empty
+        input  wire regaddr_t  wb_addr_i,           // write-back address
+        input  wire word_t     wb_data_i,           // write-back data
+        input  wire logic      wb_valid_i,          // write-back valid
+        input  wire regaddr_t  wb2_addr_i,          // second lane write-back address
+        input  wire word_t     wb2_data_i,          // second lane write-back data
+        input  wire logic      wb2_valid_i,         // second lane write-back valid
+        input  wire logic      wb_empty_i,          // wb stage empty
+
+        // jump output
+        output      logic      ready_async_o,       // stage ready for new inputs
+        output      word_t     jmp_addr_o,    // jump address
+        output      logic      jmp_valid_o,   // jump address valid
+        output      stall_t    stall_async_o,       // stall cause
+        output      logic      fencei_o,            // invalidate the instruction cache
+
+        // branch prediction
+        output wire bp_update_t bp_update_o,        // resolved control transfer, trains the predictor
+        output wire hpm_events_t hpm_events_o,      // performance counter events
+
+        // csr interface
+        output      logic      csr_retired_o,       // instruction retirement indicator
+        output      logic      csr_paired_o,        // pair issued (fused or dual, its second instruction counts as retired)
+        output      word_t     csr_trap_pc_o,       // trap program counter
+        output      mcause_t   csr_mcause_o,        // trap cause
+        output      logic      csr_mtrap_o,         // trap needed
+        output      logic      csr_mret_o,          // trap return needed
+        input  wire word_t     csr_jmp_addr_i,      // trap addr to jump to
+        input  wire logic      csr_jmp_request_i,   // trap addr valid
+        output      logic      csr_jmp_accept_o,    // jump accept
+        input  wire logic      csr_wake_i,          // interrupt pending (ends wfi)
+        output      csr_t      csr_read_addr_o,     // csr read address
+        output      logic      csr_read_enable_o,   // csr read enable
+        input  wire word_t     csr_read_data_i,     // csr read data
+        input  wire word_t     csr_read_async_i,    // csr read data (current address, no read enable)
+        output      csr_t      csr_write_addr_o,    // csr write address
+        output      word_t     csr_write_data_o,    // csr write data
+        output      logic      csr_write_enable_o,  // csr write enable
+
+        // pipeline output
+        output wire word_t     pc_o,                // program counter
+        output wire word_t     ir_o,                // instruction register
+        output wire word_t     alu_op1_o,           // ALU operand 1
+        output wire word_t     alu_op2_o,           // ALU operand 2
+        output wire alu_mode_t alu_mode_o,          // ALU mode
+        output wire ma_mode_t  ma_mode_o,           // memory access mode
+        output wire ma_size_t  ma_size_o,           // memory access size
+        output wire word_t     ma_data_o,           // memory access data (for store operations)
+        output wire wb_src_t   wb_src_o,            // write-back source
+        output wire regaddr_t  wb_addr_o,
+        output wire word_t     wb_data_o,           // write-back data
+        output wire logic      wb_ready_o,          // write-back destination
+        output wire logic      wb_valid_o,          // write-back destination
+        output wire word_t     alu2_op1_o,          // second lane ALU operand 1
+        output wire word_t     alu2_op2_o,          // second lane ALU operand 2
+        output wire alu_mode_t alu2_mode_o,         // second lane ALU mode
+        output wire regaddr_t  wb2_addr_o,          // second lane write-back address
+        output wire logic      wb2_valid_o          // second lane write-back valid
+    );
+
+initial start_logging();
+final stop_logging();
+
+
+//
+// Squash
+//
+
+logic squash_r = 1'b0;
+
+word_t pc;
+always_comb pc = squash_r ? NOP_PC : pc_i;
+
+word_t ir;
+always_comb ir = squash_r ? NOP_IR : ir_i;
+
+control_word_t cw;
+always_comb cw = squash_r ? NOP_CW : cw_i;
+
+word_t ir2;
+always_comb ir2 = squash_r ? NOP_IR : ir2_i;
+
+fuse_t fuse;
+always_comb fuse = squash_r ? FUSE_NONE : fuse_i;
+
+word_t pc2;
+always_comb pc2 = squash_r ? NOP_PC : pc2_i;
+
+control_word2_t cw2;
+always_comb cw2 = squash_r ? NOP_CW2 : cw2_i;
+
+
+//
+// Instruction Unpacking
+//
+
+regaddr_t    rs1;
+regaddr_t    rs2;
+regaddr_t    rd;
+funct3_t     f3;
+funct12_t    f12;
+csr_t        csr;
+word_t       imm_i;
+word_t       imm_s;
+word_t       imm_b;
+word_t       imm_u;
+word_t       imm_j;
+word_t       uimm;
+word_t       imm_i2;
+word_t       imm_u2;
+regaddr_t    rs1_2;
+regaddr_t    rs2_2;
+regaddr_t    rd_2;
+logic [11:0] f12_bits;
+
+always_comb begin
+    { f12_bits, rs1, f3, rd } = ir[31:7];
+    rs2 = f12_bits[4:0];
+    csr = f12_bits;
+    f12 = f12_bits;
+
+    imm_i = { {21{ir[31]}}, ir[30:25], ir[24:21], ir[20] };
+    imm_s = { {21{ir[31]}}, ir[30:25], ir[11:8], ir[7] };
+    imm_b = { {20{ir[31]}}, ir[7], ir[30:25], ir[11:8], 1'b0 };
+    imm_u = { ir[31], ir[30:20], ir[19:12], 12'b0 };
+    imm_j = { {12{ir[31]}}, ir[19:12], ir[20], ir[30:25], ir[24:21], 1'b0 };
+    uimm  = { 27'b0, ir[19:15] };
+
+    imm_i2 = { {21{ir2[31]}}, ir2[30:25], ir2[24:21], ir2[20] };
+    imm_u2 = { ir2[31], ir2[30:20], ir2[19:12], 12'b0 };
+    rs1_2  = ir2[19:15];
+    rs2_2  = ir2[24:20];
+    rd_2   = ir2[11:7];
+end
+
+
+//
+// Privileged Operations
+//
+
+// gating jump requests
+always_comb begin
+    csr_jmp_accept_o = csr_jmp_request_i && (pc != NOP_PC) && ready_async_o;
+end
+
+// traps and returns
+logic wfi;
+logic misaligned;  // see Misaligned Accesses
+always_comb begin
+    csr_trap_pc_o = pc;
+    csr_mtrap_o   = 1'b0;
+    csr_mret_o    = 1'b0;
+    csr_mcause_o  = '{ 1'b0, 31'b0 };
+    wfi           = 1'b0;
+
+    if (misaligned) begin
+        csr_mtrap_o  = 1'b1;
+        csr_mcause_o = '{ 1'b0, (cw.ma_mode == MA_LOAD || (cw.ma_mode == MA_AMO && ir[31:27] == F5_LR)) ? EXC_LOAD_MISALIGNED : EXC_STORE_MISALIGNED };
+    end
+
+    if (cw.priv) begin
+        unique case (f12)
+        F12_ECALL:
+            begin
+                csr_mtrap_o  = 1'b1;
+                csr_mcause_o = '{ 1'b0, ECALL_M        };
+            end
+        F12_EBREAK:
+            begin
+                csr_mtrap_o  = 1'b1;
+                csr_mcause_o = '{ 1'b0, EXC_BREAKPOINT };
+            end
+        F12_MRET,
+        F12_SRET:
+            begin
+                csr_mret_o   = 1'b1;
+            end
+        F12_WFI:
+            begin
+                csr_trap_pc_o = pc_next_i;
+                wfi           = !csr_jmp_request_i && !csr_wake_i;
+            end
+        endcase
+    end
+end
+
+
+//
+// Data Hazard Detection
+//
+
+logic data_hazard, ra_collision, rb_collision, ra2_collision, rb2_collision;
+
+// loads are forwarded from the memory read data as it arrives, so everything past MA is ready
+// (second lane results are ready once they leave EX)
+function automatic logic collision(logic used, regaddr_t rs);
+    return used && ((wb_valid_r && wb_addr_r == rs && !wb_ready_r) || (wb2_valid_r && wb2_addr_r == rs) || (ex_wb_valid_i && ex_wb_addr_i == rs && !ex_wb_ready_i));
+endfunction
+
+always_comb begin
+    ra_collision  = collision(cw.ra_used,  rs1);
+    rb_collision  = collision(cw.rb_used,  rs2);
+    ra2_collision = collision(cw2.ra_used, rs1_2);
+    rb2_collision = collision(cw2.rb_used, rs2_2);
+    data_hazard   = ra_collision || rb_collision || ra2_collision || rb2_collision;
+end
+
+
+//
+// Register File Access
+//
+
+// output values from register file
+wire word_t    ra;
+wire word_t    rb;
+wire word_t    ra2;
+wire word_t    rb2;
+     regaddr_t wb_addr;
+     word_t    wb_data;
+     logic     wb_enable;
+
+regfile regfile (
+    .clk_i              (clk_i),
+    .read1_addr_i       (rs1),
+    .read1_data_async_o (ra),
+    .read2_addr_i       (rs2),
+    .read2_data_async_o (rb),
+    .read3_addr_i       (rs1_2),
+    .read3_data_async_o (ra2),
+    .read4_addr_i       (rs2_2),
+    .read4_data_async_o (rb2),
+    .write_addr_i       (wb_addr),
+    .write_data_i       (wb_data),
+    .write_enable_i     (wb_enable),
+    .write2_addr_i      (wb2_addr_i),
+    .write2_data_i      (wb2_data_i),
+    .write2_enable_i    (wb2_valid_i)
+);
+
+
+//
+// Register File Bypass
+//
+
+// Bypassed Values
+word_t ra_bypassed;
+word_t rb_bypassed;
+word_t ra2_bypassed;
+word_t rb2_bypassed;
+
+// youngest result wins, and at each stage the second lane is younger than the first
+// (a result still waiting in front of EX is a data hazard, so its value doesn't matter)
+function automatic word_t bypass(regaddr_t rs, word_t rf_data);
+    word_t data;
+    priority if (wb_valid_r && rs == wb_addr_r)
+        data = wb_data_r;
+    else if (ex_wb2_valid_i && rs == ex_wb2_addr_i)
+        data = ex_wb2_data_i;
+    else if (ex_wb_valid_i && rs == ex_wb_addr_i)
+        data = ex_wb_data_i;
+    else if (ma_wb2_valid_i && rs == ma_wb2_addr_i)
+        data = ma_wb2_data_i;
+    else if (ma_wb_valid_i && rs == ma_wb_addr_i)
+        data = ma_wb_data_i;
+    else if (wb2_valid_i && rs == wb2_addr_i)
+        data = wb2_data_i;
+    else if (wb_valid_i && rs == wb_addr_i)
+        data = wb_data_i;
+    else
+        data = rf_data;
+    return data;
+endfunction
+
+always_comb begin
+    ra_bypassed  = bypass(rs1,   ra);
+    rb_bypassed  = bypass(rs2,   rb);
+    ra2_bypassed = bypass(rs1_2, ra2);
+    rb2_bypassed = bypass(rs2_2, rb2);
+end
+
+
+//
+// ALU Operands
+//
+
+word_t alu_op1_next;
+word_t alu_op2_next;
+
+always_comb begin
+    unique case (cw.alu_op1)
+    ALU_OP1_X:    alu_op1_next = 32'b0;
+    ALU_OP1_RS1:  alu_op1_next = ra_bypassed;
+    ALU_OP1_IMMU: alu_op1_next = imm_u;
+    endcase
+end
+
+always_comb begin
+    unique case (cw.alu_op2)
+    ALU_OP2_X:    alu_op2_next = 32'b0;
+    ALU_OP2_RS2:  alu_op2_next = rb_bypassed;
+    ALU_OP2_IMMI: alu_op2_next = imm_i;
+    ALU_OP2_IMMS: alu_op2_next = imm_s;
+    ALU_OP2_PC:   alu_op2_next = pc;
+    endcase
+
+    // fused pairs take the second instruction's immediate (slli+srli packs both shift amounts)
+    unique case (fuse)
+    FUSE_LUI_ADDI:  alu_op2_next = imm_i2;
+    FUSE_SLLI_SRLI: alu_op2_next = { 22'b0, ir2[24:20], ir[24:20] };
+    default:        ;
+    endcase
+end
+
+// second lane (plain ALU instructions only)
+word_t alu2_op1_next;
+word_t alu2_op2_next;
+
+always_comb begin
+    unique case (cw2.alu_op1)
+    ALU_OP1_RS1:  alu2_op1_next = ra2_bypassed;
+    ALU_OP1_IMMU: alu2_op1_next = imm_u2;
+    default:      alu2_op1_next = 32'b0;
+    endcase
+end
+
+always_comb begin
+    unique case (cw2.alu_op2)
+    ALU_OP2_RS2:  alu2_op2_next = rb2_bypassed;
+    ALU_OP2_IMMI: alu2_op2_next = imm_i2;
+    ALU_OP2_PC:   alu2_op2_next = pc2;
+    default:      alu2_op2_next = 32'b0;
+    endcase
+end
+
+
+//
+// Misaligned Accesses
+//
+
+// MA splits misaligned loads and stores in two, unless built to trap them, but atomics always trap
+// (the address is the base register plus the immediate, only its low bits are needed)
+logic [1:0] ma_offset;
+always_comb begin
+    ma_offset  = alu_op1_next[1:0] + alu_op2_next[1:0];
+    misaligned = (cw.ma_mode == MA_AMO || (TRAP_MISALIGNED && (cw.ma_mode == MA_LOAD || cw.ma_mode == MA_STORE)))
+              && is_misaligned(cw.ma_size, ma_offset) && !ra_collision;
+end
+
+
+//
+// CSR Read/Write State Machine
+//
+
+// states
+typedef enum logic [1:0] {
+    CSR_STATE_IDLE      = 2'b00,
+    CSR_STATE_FLUSHING  = 2'b01,
+    CSR_STATE_EXECUTING = 2'b10
+} csr_state_t;
+
+// CSR instructions that don't write (csrrs/csrrc with x0, csrrsi/csrrci with 0) have no side effects,
+// so they read in the normal pipeline and carry the value to writeback like a link address
+logic csr_read_only;
+always_comb csr_read_only = cw.csr_used && f3[1] && rs1 == 5'b0;
+
+// transitions
+csr_state_t csr_state_r = CSR_STATE_IDLE;
+csr_state_t csr_state_next;
+logic csr_idle_action;   // normal idle transition
+logic csr_flush_action;  // start processing a CSR by flushing the pipeline
+logic csr_wait_action;   // continuing to flush pipeline
+logic csr_read_action;   // reading current CSR value
+logic csr_write_action;  // writing new CSR value and performing register write-back
+
+// determine transition
+always_comb begin
+    csr_idle_action  = (csr_state_r == CSR_STATE_IDLE)     && (~cw.csr_used || csr_read_only);
+    csr_flush_action = (csr_state_r == CSR_STATE_IDLE)     && ( cw.csr_used && ~csr_read_only);
+    csr_wait_action  = (csr_state_r == CSR_STATE_FLUSHING) && ~(ex_empty_i && ma_empty_i && wb_empty_i);
+    csr_read_action  = (csr_state_r == CSR_STATE_FLUSHING) &&  (ex_empty_i && ma_empty_i && wb_empty_i);
+    csr_write_action = (csr_state_r == CSR_STATE_EXECUTING);
+end
+
+// determine next state
+/* verilator lint_off LATCH */
+always_comb begin
+    unique if (csr_idle_action || csr_write_action)
+        csr_state_next = CSR_STATE_IDLE;
+    else if (csr_flush_action || csr_wait_action)
+        csr_state_next = CSR_STATE_FLUSHING;
+    else if (csr_read_action)
+        csr_state_next = CSR_STATE_EXECUTING;
+end
+/* verilator lint_on LATCH */
+
+// update CSR control signals
+always_comb begin
+    // always read and write from the CSR specified in the instruction
+    csr_read_addr_o  = csr;
+    csr_write_addr_o = csr;
+
+    // read on read action unless there's nowhere to put it
+    csr_read_enable_o  = csr_read_action && rd != 5'b0;
+
+    unique case (f3)
+    F3_CSRRW,  // the RW variations always write on exec action
+    F3_CSRRWI: csr_write_enable_o = csr_write_action;
+    F3_CSRRS,  // the Set/Clear variations write on exec action unless x0 is specified
+    F3_CSRRC:  csr_write_enable_o = csr_write_action && (rs1 != 5'b0);
+    F3_CSRRSI, // the Set/Clear Immediate variations write on exec action unless the immediate value is 0
+    F3_CSRRCI: csr_write_enable_o = csr_write_action && (uimm != 32'b0);
+    default:   csr_write_enable_o = 1'b0;
+    endcase
+
+    unique case (f3)
+    F3_CSRRW:  csr_write_data_o = ra_bypassed;                    // 
+    F3_CSRRWI: csr_write_data_o = uimm;
+    F3_CSRRS:  csr_write_data_o = csr_read_data_i | ra_bypassed;
+    F3_CSRRSI: csr_write_data_o = csr_read_data_i | uimm;
+    F3_CSRRC:  csr_write_data_o = csr_read_data_i & ~ra_bypassed;
+    F3_CSRRCI: csr_write_data_o = csr_read_data_i & ~uimm;
+    default:   csr_write_data_o = 32'b0;
+    endcase
+
+    // consider this an instruction retirement if writeback stage is retiring OR we are
+    csr_retired_o = !wb_empty_i || csr_state_r == CSR_STATE_EXECUTING;
+end
+
+// update regfile writeback control siganls
+always_comb begin
+    // If CSR is writing, it owns the register file's write port
+    unique if (csr_write_action) begin
+        wb_addr   = rd;
+        wb_data   = csr_read_data_i;
+        wb_enable = csr_write_action && rd != 5'b0;
+    // Otherwise, it comes from the writeback stage
+    end else begin
+        wb_addr   = wb_addr_i;
+        wb_data   = wb_data_i;
+        wb_enable = wb_valid_i;
+    end
+end
+
+// advance to next state
+always_ff @(posedge clk_i) begin
+    `log_strobe(("{ \"stage\": \"RR\", \"pc\": \"%0d\", \"csr_addr\": \"%0d\", \"csr_state\": \"%0d\", \"csr_read_data\": \"%0d\", \"csr_write_data\": \"%0d\", \"csr_wb_addr\": \"%0d\", \"csr_wb_enable\": \"%0d\", \"csr_write_enable\": \"%0d\" }", pc, csr, csr_state_r, csr_read_data_i, csr_write_data_o, wb_addr, wb_enable, csr_write_enable_o));
+
+    csr_state_r <= csr_state_next;
+end
+
+
+//
+// Async Output
+//
+
+logic branch_condition;
+always_comb begin
+    unique case (f3[2:1])
+        2'b00: branch_condition = (        ra_bypassed  ==         rb_bypassed);
+        2'b10: branch_condition = (signed'(ra_bypassed) <  signed'(rb_bypassed));
+        2'b11: branch_condition = (        ra_bypassed  <          rb_bypassed);
+        2'b01: branch_condition = 1'b0;
+    endcase
+    branch_condition = f3[0] ? !branch_condition : branch_condition;
+end
+
+// where control actually goes after this instruction
+word_t actual_pc;
+logic  taken;
+always_comb begin
+    unique case (cw.pc_mode)
+    PC_NEXT:     taken = 1'b0;
+    PC_JUMP_REL: taken = 1'b1;
+    PC_JUMP_ABS: taken = 1'b1;
+    PC_BRANCH:   taken = branch_condition;
+    endcase
+
+    unique case (cw.pc_mode)
+    PC_NEXT:     actual_pc = pc_next_i;
+    PC_JUMP_REL: actual_pc = pc + imm_j;
+    PC_JUMP_ABS: actual_pc = ra_bypassed + imm_i;
+    PC_BRANCH:   actual_pc = taken ? (pc + imm_b) : pc_next_i;
+    endcase
+
+    // auipc+jalr adds both halves of the offset to the auipc's pc
+    if (fuse == FUSE_AUIPC_JALR)
+        actual_pc = pc + imm_u + imm_i2;
+end
+
+// fetch followed the wrong path if it didn't predict where this instruction goes
+// (an instruction interrupted by a trap isn't issued, it runs again after the handler returns)
+logic accepted;
+logic mispredict;
+always_comb begin
+    accepted   = ready_async_o && (pc != NOP_PC) && !csr_jmp_accept_o;
+    mispredict = accepted && (actual_pc != pred_pc_i);
+end
+
+// fence.i invalidates the instruction cache and refetches everything behind it
+// (older stores may still sit in the store buffer or dirty dcache lines, but instructions
+//  are only fetched from the BIOS ROM, which stores never reach, so the refetch doesn't wait;
+//  the fence itself still drains the store buffer in MA like any other fence)
+logic fencei;
+always_comb begin
+    fencei = accepted && ir[6:0] == OP_MISC_MEM && f3 == F3_FENCEI;
+end
+
+always_ff @(posedge clk_i) begin
+    // jump signals
+    unique if (csr_jmp_request_i && csr_jmp_accept_o) begin
+        jmp_valid_o <= 1'b1;
+        jmp_addr_o  <= csr_jmp_addr_i;
+        squash_r    <= 1'b1;
+    end else begin
+        // redirect fetch to the resolved address on a misprediction
+        jmp_valid_o <= mispredict || fencei;
+        jmp_addr_o  <= actual_pc;
+        squash_r    <= mispredict || fencei;
+    end
+
+    fencei_o <= fencei;
+end
+
+
+//
+// Branch Prediction Training
+//
+
+bp_update_t  bp_update_r  = '0;
+assign       bp_update_o  = bp_update_r;
+
+hpm_events_t hpm_events_r = '0;
+assign       hpm_events_o = hpm_events_r;
+
+always_ff @(posedge clk_i) begin
+    // train on every control transfer, and on anything else fetch thought was one
+    // (a fused auipc+jalr trains the jalr, which is what fetch predicts)
+    bp_update_r <= '{
+        valid:  accepted && (cw.pc_mode != PC_NEXT || mispredict),
+        pc:     (fuse == FUSE_AUIPC_JALR) ? pc + 32'd4 : pc,
+        branch: cw.pc_mode == PC_BRANCH,
+        direct: cw.pc_mode == PC_JUMP_REL,
+        taken:  taken,
+        target: actual_pc,
+        call:   (fuse == FUSE_AUIPC_JALR) ? is_call(ir2)   : is_call(ir),
+        ret:    (fuse == FUSE_AUIPC_JALR) ? is_return(ir2) : is_return(ir),
+        link:   pc_next_i
+    };
+
+    hpm_events_r                  <= '0;
+    hpm_events_r[HPM_BRANCH_HIT]  <= accepted && (cw.pc_mode != PC_NEXT) && !mispredict;
+    hpm_events_r[HPM_BRANCH_MISS] <= mispredict;
+    hpm_events_r[HPM_RETURN_HIT]  <= accepted && is_return(ir) && !mispredict;
+    hpm_events_r[HPM_RETURN_MISS] <= accepted && is_return(ir) &&  mispredict;
+
+    hpm_events_r[HPM_FUSE_LUI_ADDI]   <= accepted && fuse == FUSE_LUI_ADDI;
+    hpm_events_r[HPM_FUSE_AUIPC_JALR] <= accepted && fuse == FUSE_AUIPC_JALR;
+    hpm_events_r[HPM_FUSE_SLLI_SRLI]  <= accepted && fuse == FUSE_SLLI_SRLI;
+    hpm_events_r[HPM_DUAL_ISSUE]      <= accepted && pc2 != NOP_PC;
+end
+
+// a pair retires as one operation, so its second instruction is counted as it issues
+// (nothing issued from RR is cancelled, so instret stays exact)
+always_comb begin
+    csr_paired_o = accepted && (fuse != FUSE_NONE || pc2 != NOP_PC);
+end
+
+always_comb begin
+    // we only want a new instruction if EX can take ours, we aren't dealing with a data hazard, and we aren't going to be dealing with a CSR instruction
+    ready_async_o = ex_ready_i && !data_hazard && (csr_state_next == CSR_STATE_IDLE) && !wfi;
+
+    priority if (!ex_ready_i)
+        stall_async_o = STALL_MEMORY;
+    else if (data_hazard)
+        stall_async_o = STALL_DATA;
+    else if (csr_state_next != CSR_STATE_IDLE)
+        stall_async_o = STALL_CSR;
+    else if (wfi)
+        stall_async_o = STALL_WFI;
+    else
+        stall_async_o = STALL_NONE;
+
+    `log_display(("{ \"stage\": \"RR\", \"pc\": \"%0d\", \"jmp_valid\": \"%0d\", \"jmp_addr\": \"%0d\", \"ready\": \"%0d\" }", pc, jmp_valid_o, jmp_addr_o, ready_async_o));
+end
+
+
+//
+// Pipeline Output
+//
+
+word_t     pc_r       = NOP_PC;
+assign     pc_o       = pc_r;
+
+word_t     ir_r       = NOP_IR;
+assign     ir_o       = ir_r;
+
+word_t     alu_op1_r  = 32'b0;
+assign     alu_op1_o  = alu_op1_r;
+
+word_t     alu_op2_r  = 32'b0;
+assign     alu_op2_o  = alu_op2_r;
+
+alu_mode_t alu_mode_r = NOP_ALU_MODE;
+assign     alu_mode_o = alu_mode_r;
+
+ma_mode_t  ma_mode_r  = NOP_MA_MODE;
+assign     ma_mode_o  = ma_mode_r;
+
+ma_size_t  ma_size_r  = NOP_MA_SIZE;
+assign     ma_size_o  = ma_size_r;
+
+word_t     ma_data_r  = 32'b0;
+assign     ma_data_o  = ma_data_r;
+
+wb_src_t   wb_src_r   = NOP_WB_SRC;
+assign     wb_src_o   = wb_src_r;
+
+regaddr_t  wb_addr_r  = NOP_WB_ADDR;
+assign     wb_addr_o  = wb_addr_r;
+
+word_t     wb_data_r  = 32'b0;
+assign     wb_data_o  = wb_data_r;
+
+logic      wb_ready_r = 1'b0;
+assign     wb_ready_o = wb_ready_r;
+
+logic      wb_valid_r = NOP_WB_VALID;
+assign     wb_valid_o = wb_valid_r;
+
+logic      halt_r     = 1'b0;
+assign     halt_o     = halt_r;
+
+word_t     alu2_op1_r  = 32'b0;
+assign     alu2_op1_o  = alu2_op1_r;
+
+word_t     alu2_op2_r  = 32'b0;
+assign     alu2_op2_o  = alu2_op2_r;
+
+alu_mode_t alu2_mode_r = NOP_ALU_MODE;
+assign     alu2_mode_o = alu2_mode_r;
+
+regaddr_t  wb2_addr_r  = NOP_WB_ADDR;
+assign     wb2_addr_o  = wb2_addr_r;
+
+logic      wb2_valid_r = NOP_WB_VALID;
+assign     wb2_valid_o = wb2_valid_r;
+
+always_ff @(posedge clk_i) begin
+    if (!ex_ready_i) begin
+        // EX is holding its instruction, so hold ours
+    end else if (data_hazard || !csr_idle_action || wfi || csr_jmp_accept_o) begin
+        // a bubble is needed (or the instruction is being interrupted), output a NOP (addi x0, x0, 0)
+        pc_r       <= NOP_PC;
+        ir_r       <= NOP_IR;
+        alu_op1_r  <= 32'b0;
+        alu_op2_r  <= 32'b0;
+        alu_mode_r <= NOP_ALU_MODE;
+        ma_mode_r  <= NOP_MA_MODE;
+        ma_size_r  <= NOP_MA_SIZE;
+        ma_data_r  <= 32'b0;
+        wb_src_r   <= NOP_WB_SRC;
+        wb_addr_r  <= NOP_WB_ADDR;
+        wb_data_r  <= 32'b0;
+        wb_ready_r <= 1'b0;
+        wb_valid_r <= NOP_WB_VALID;
+        halt_r     <= 1'b0;
+
+        alu2_op1_r  <= 32'b0;
+        alu2_op2_r  <= 32'b0;
+        alu2_mode_r <= NOP_ALU_MODE;
+        wb2_addr_r  <= NOP_WB_ADDR;
+        wb2_valid_r <= NOP_WB_VALID;
+    end else begin
+        // otherwise, output decoded control signals
+        pc_r       <= pc;
+        ir_r       <= ir;
+        alu_op1_r  <= alu_op1_next;
+        alu_op2_r  <= alu_op2_next;
+        alu_mode_r <= cw.alu_mode;
+        ma_mode_r  <= cw.ma_mode;
+        ma_size_r  <= cw.ma_size;
+        ma_data_r  <= rb_bypassed;
+        wb_src_r   <= cw.wb_src;
+        wb_addr_r  <= rd;
+        wb_data_r  <= pc_next_i;
+        wb_ready_r <= (cw.wb_src == WB_SRC_PC4);
+        wb_valid_r <= cw.wb_valid;
+        halt_r     <= cw.halt || cw2.halt;
+
+        alu2_op1_r  <= alu2_op1_next;
+        alu2_op2_r  <= alu2_op2_next;
+        alu2_mode_r <= cw2.alu_mode;
+        wb2_addr_r  <= rd_2;
+        wb2_valid_r <= cw2.wb_valid;
+
+        if (csr_read_only) begin
+            wb_src_r   <= WB_SRC_PC4;
+            wb_data_r  <= csr_read_async_i;
+            wb_ready_r <= 1'b1;
+            wb_valid_r <= rd != 5'b0;
+        end
+    end
+
+    // $display("[RR (%x)] PC=%x, IR=%x | JMP=%x, %x | CSR JMP=%x, %x, %x | PC=%x, IR=%x", ready_async_o, pc, ir, jmp_addr_o, jmp_valid_o, csr_jmp_request_i, csr_jmp_addr_i, csr_jmp_accept_o, pc_o, ir_o);
+    `log_strobe(("{ \"stage\": \"RR\", \"pc\": \"%0d\", \"ir\": \"%0d\", \"alu_op1\": \"%0d\", \"alu_op2\": \"%0d\", \"alu_mode\": \"%0d\", \"ma_mode\": \"%0d\", \"ma_size\": \"%0d\", \"ma_data\": \"%0d\", \"wb_src\": \"%0d\", \"wb_data\": \"%0d\", \"wb_dst\": \"%0d\", \"halt\": \"%0d\" }", pc_r, ir_r, alu_op1_r, alu_op2_r, alu_mode_r, ma_mode_r, ma_size_r, ma_data_r, wb_src_r, wb_data_r, wb_valid_r, halt_r));
+end
+
+endmodule
@@ -27,14 +27,21 @@ module stage_writeback
         input  wire word_t      wb_data_i,        // write-back data
         input  wire logic       wb_ready_i,       // write-back valid
         input  wire logic       wb_valid_i,       // write-back valid
+        input  wire regaddr_t   wb2_addr_i,       // second lane write-back address
+        input  wire word_t      wb2_data_i,       // second lane write-back data
+        input  wire logic       wb2_valid_i,      // second lane write-back valid
 
         // status outputs
         output      logic       empty_async_o,    // stage empty
+        output      word_t      wb_data_async_o,  // write-back data, including load results (for bypass)
 
         // pipline outputs
         output      regaddr_t   wb_addr_o,        // write-back address
         output      word_t      wb_data_o,        // write-back data
-        output      logic       wb_valid_o        // write-back valid
+        output      logic       wb_valid_o,       // write-back valid
+        output      regaddr_t   wb2_addr_o,       // second lane write-back address
+        output      word_t      wb2_data_o,       // second lane write-back data
+        output      logic       wb2_valid_o       // second lane write-back valid
     );
 
 initial start_logging();
@@ -45,18 +52,33 @@ final stop_logging();
 // Async Outputs
 //
 
-word_t unaligned;
-word_t aligned;
+logic [55:0] unaligned;
+word_t       aligned;
 
 always_comb begin
-    unaligned = load_i ? dmem_read_data_i : wb_data_i;
+    // a load split across two words has the first word as its write-back data
+    if (!load_i)
+        unaligned = { 24'b0, wb_data_i };
+    else if (crosses_word(ma_size_i, ma_alignment_i))
+        unaligned = { dmem_read_data_i[23:0], wb_data_i };
+    else
+        unaligned = { 24'b0, dmem_read_data_i };
 
     // shift data right based on address lower bits
     unique case (ma_alignment_i)
-    2'b00: aligned = {        unaligned[31: 0] };
-    2'b01: aligned = {  8'b0, unaligned[31: 8] };
-    2'b10: aligned = { 16'b0, unaligned[31:16] };
-    2'b11: aligned = { 24'b0, unaligned[31:24] };
+    2'b00: aligned = unaligned[31: 0];
+    2'b01: aligned = unaligned[39: 8];
+    2'b10: aligned = unaligned[47:16];
+    2'b11: aligned = unaligned[55:24];
+    endcase
+
+    // should probably be a separate WB_SIZE value???
+    unique case (ma_size_i)
+    MA_SIZE_B:   wb_data_async_o = { {24{aligned[ 7]}},  aligned[ 7:0] };
+    MA_SIZE_H:   wb_data_async_o = { {16{aligned[15]}},  aligned[15:0] };
+    MA_SIZE_BU:  wb_data_async_o = { 24'b0,              aligned[ 7:0] };
+    MA_SIZE_HU:  wb_data_async_o = { 16'b0,              aligned[15:0] };
+    MA_SIZE_W:   wb_data_async_o = aligned;
     endcase
 
     empty_async_o = (pc_i == NOP_PC);
@@ -76,19 +98,24 @@ assign      wb_data_o  = wb_data_r;
 logic       wb_valid_r = 1'b0;
 assign      wb_valid_o = wb_valid_r;
 
-always_ff @(posedge clk_i) begin
-    // should probably be a separate WB_SIZE value???
-    unique case (ma_size_i)
-    MA_SIZE_B:   wb_data_r <= { {24{aligned[ 7]}},  aligned[ 7:0] };
-    MA_SIZE_H:   wb_data_r <= { {16{aligned[15]}},  aligned[15:0] };
-    MA_SIZE_BU:  wb_data_r <= { 24'b0,              aligned[ 7:0] };
-    MA_SIZE_HU:  wb_data_r <= { 16'b0,              aligned[15:0] };
-    MA_SIZE_W:   wb_data_r <= aligned;
-    endcase
+regaddr_t   wb2_addr_r  = 5'b0;
+assign      wb2_addr_o  = wb2_addr_r;
+
+word_t      wb2_data_r  = 32'b0;
+assign      wb2_data_o  = wb2_data_r;
 
+logic       wb2_valid_r = 1'b0;
+assign      wb2_valid_o = wb2_valid_r;
+
+always_ff @(posedge clk_i) begin
+    wb_data_r  <= wb_data_async_o;
     wb_addr_r  <= wb_addr_i;
     wb_valid_r <= wb_valid_i;
 
+    wb2_data_r  <= wb2_data_i;
+    wb2_addr_r  <= wb2_addr_i;
+    wb2_valid_r <= wb2_valid_i;
+
     `log_strobe(("{ \"stage\": \"WB\", \"pc\": \"%0d\", \"ir\": \"%0d\", \"wb_addr\": \"%0d\", \"wb_data\": \"%0d\", \"wb_valid\": \"%0d\" }", pc_i, ir_i, wb_addr_o, wb_data_o, wb_valid_o));
 end
 
@@ -0,0 +1,170 @@
+`timescale 1ns / 1ps
+`default_nettype none
+
+///
+/// Risc-V CPU Store Buffer
+///
+/// Specs:
+/// Queues stores to memory (anything but MMIO) so they retire without waiting on the data cache
+/// Drains in order whenever the memory access stage isn't using the cache port
+/// Younger loads see buffered stores (byte-wise forwarding merged over the cache's read data)
+/// MMIO accesses and fences wait for the buffer to drain
+///
+
+module store_buffer
+    // Import Constants
+    import common::*;
+    import cpu_common::*;
+    #(
+        parameter int unsigned SB_BITS = 2             // log2(store buffer entries)
+    )
+    (
+        input  wire logic        clk_i,                // clock
+
+        // cpu port
+        input  wire word_t       cpu_addr_i,           // address (word aligned)
+        input  wire logic        cpu_read_enable_i,    // read enable
+        input  wire word_t       cpu_write_data_i,     // write data
+        input  wire logic [3:0]  cpu_write_mask_i,     // write mask
+        input  wire logic        cpu_fence_i,          // wait for all buffered stores to drain
+        output      logic        cpu_ready_async_o,    // request accepted this cycle
+        output      word_t       cpu_read_data_o,      // read data of the previous cycle's accepted request
+
+        // memory port
+        output      word_t       mem_addr_o,           // address
+        output      logic        mem_read_enable_o,    // read enable
+        output      word_t       mem_write_data_o,     // write data
+        output      logic [3:0]  mem_write_mask_o,     // write mask
+        input  wire logic        mem_ready_i,          // request accepted this cycle
+        input  wire word_t       mem_read_data_i       // read data of the previous cycle's accepted request
+    );
+
+
+//
+// Buffer
+//
+
+localparam int unsigned SB_DEPTH = 2**SB_BITS;
+
+typedef logic [SB_BITS-1:0] sb_ptr_t;
+typedef logic [SB_BITS:0]   sb_count_t;
+
+typedef struct packed {
+    word_t      addr;  // address (word aligned)
+    word_t      data;  // write data
+    logic [3:0] mask;  // write mask
+} sb_entry_t;
+
+sb_entry_t [SB_DEPTH-1:0] entries_r = '0;
+sb_ptr_t                  head_r    = '0;  // oldest store
+sb_ptr_t                  tail_r    = '0;  // next free entry
+sb_count_t                count_r   = '0;
+
+logic empty;
+logic full;
+always_comb begin
+    empty = count_r == '0;
+    full  = count_r == sb_count_t'(SB_DEPTH);
+end
+
+// MMIO has side effects, so it is neither buffered nor reordered around buffered stores
+function automatic logic bufferable(word_t addr);
+    return addr[31:28] != 4'hF;
+endfunction
+
+
+//
+// Port Arbitration
+//
+
+logic store;    // cpu store, goes into the buffer
+logic access;   // cpu access, goes straight to memory
+logic enqueue;  // store accepted into the buffer
+logic drain;    // oldest store offered to memory
+logic dequeue;  // oldest store accepted by memory
+
+always_comb begin
+    store  = (cpu_write_mask_i != 4'b0000) && bufferable(cpu_addr_i);
+    access = (cpu_read_enable_i && bufferable(cpu_addr_i))
+          || ((cpu_read_enable_i || cpu_write_mask_i != 4'b0000) && !bufferable(cpu_addr_i) && empty);
+
+    // loads and MMIO have the port, buffered stores use it the rest of the time
+    drain   = !access && !empty;
+    dequeue = drain && mem_ready_i;
+    enqueue = store && (!full || dequeue);
+
+    unique if (access)
+        cpu_ready_async_o = mem_ready_i;
+    else if (store)
+        cpu_ready_async_o = enqueue;
+    else if (cpu_fence_i || cpu_read_enable_i || cpu_write_mask_i != 4'b0000)
+        cpu_ready_async_o = empty;
+    else
+        cpu_ready_async_o = 1'b1;
+
+    if (drain) begin
+        mem_addr_o        = entries_r[head_r].addr;
+        mem_read_enable_o = 1'b0;
+        mem_write_data_o  = entries_r[head_r].data;
+        mem_write_mask_o  = entries_r[head_r].mask;
+    end else begin
+        mem_addr_o        = cpu_addr_i;
+        mem_read_enable_o = access && cpu_read_enable_i;
+        mem_write_data_o  = cpu_write_data_i;
+        mem_write_mask_o  = access ? cpu_write_mask_i : 4'b0000;
+    end
+end
+
+always_ff @(posedge clk_i) begin
+    if (enqueue) begin
+        entries_r[tail_r] <= '{ addr: cpu_addr_i, data: cpu_write_data_i, mask: cpu_write_mask_i };
+        tail_r            <= tail_r + 1'b1;
+    end
+
+    if (dequeue)
+        head_r <= head_r + 1'b1;
+
+    count_r <= count_r + sb_count_t'(enqueue) - sb_count_t'(dequeue);
+end
+
+
+//
+// Store to Load Forwarding
+//
+
+// buffered bytes of the load's word, younger stores overriding older ones
+sb_entry_t  entry;
+word_t      forward_data;
+logic [3:0] forward_mask;
+always_comb begin
+    entry        = '0;
+    forward_data = 32'b0;
+    forward_mask = 4'b0000;
+
+    for (int i=0; i<SB_DEPTH; i++) begin
+        entry = entries_r[head_r + sb_ptr_t'(i)];
+        if (sb_count_t'(i) < count_r && entry.addr == cpu_addr_i) begin
+            for (int b=0; b<4; b++) begin
+                if (entry.mask[b]) begin
+                    forward_data[b*8 +: 8] = entry.data[b*8 +: 8];
+                    forward_mask[b]        = 1'b1;
+                end
+            end
+        end
+    end
+end
+
+word_t      forward_data_r = '0;
+logic [3:0] forward_mask_r = 4'b0000;
+
+always_ff @(posedge clk_i) begin
+    forward_data_r <= forward_data;
+    forward_mask_r <= (access && cpu_read_enable_i) ? forward_mask : 4'b0000;
+end
+
+always_comb begin
+    for (int b=0; b<4; b++)
+        cpu_read_data_o[b*8 +: 8] = forward_mask_r[b] ? forward_data_r[b*8 +: 8] : mem_read_data_i[b*8 +: 8];
+end
+
+endmodule
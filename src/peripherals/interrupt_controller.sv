@@ -4,6 +4,11 @@
 ///
 /// Interrupt Controller
 ///
+/// Specs:
+/// Source n has claim ID n+1, lower IDs have priority
+/// Reading the claim port returns the highest priority active ID (or 0) and masks that source
+/// Writing an ID to the claim port completes it, unmasking the source
+///
 
 module interrupt_controller
     // Import Constants
@@ -28,15 +33,34 @@ module interrupt_controller
 typedef enum logic [3:0] {
     PORT_PENDING = 4'b0000,
     PORT_ENABLED = 4'b0001,
-    PORT_ACTIVE  = 4'b0010
+    PORT_ACTIVE  = 4'b0010,
+    PORT_CLAIM   = 4'b0011
 } port_t;
 
 word_t pending_r = '0;
 word_t enabled_r = '0;
+word_t claimed_r = '0;
 word_t active;
 
 always_comb begin
-    active = pending_r & enabled_r;
+    active = pending_r & enabled_r & ~claimed_r;
+end
+
+// priority encoder: lowest active source wins
+word_t claim;
+always_comb begin
+    claim = 32'b0;
+    for (int i=31; i>=0; i--)
+        if (active[i])
+            claim = 32'(i + 1);
+end
+
+always_ff @(posedge clk_i) begin
+    if (chip_select_i && read_enable_i && addr_i == PORT_CLAIM && claim != 32'b0)
+        claimed_r[claim[4:0] - 5'd1] <= 1'b1;
+
+    if (chip_select_i && write_mask_i != 4'b0000 && addr_i == PORT_CLAIM && write_data_i != 32'b0)
+        claimed_r[write_data_i[4:0] - 5'd1] <= 1'b0;
 end
 
 always_ff @(posedge clk_i) begin
@@ -58,6 +82,7 @@ always_ff @(posedge clk_i) begin
         PORT_PENDING: read_data_r <= pending_r;
         PORT_ENABLED: read_data_r <= enabled_r;
         PORT_ACTIVE:  read_data_r <= active;
+        PORT_CLAIM:   read_data_r <= claim;
         default:      read_data_r <= 32'b0;
         endcase
     end
@@ -0,0 +1,91 @@
+`timescale 1ns / 1ps
+`default_nettype none
+
+///
+/// Machine Timer (mtime/mtimecmp)
+///
+/// Specs:
+/// mtime counts cpu cycles and is shadowed by the time CSR
+/// Timer interrupt (mip.MTIP) is raised while mtime >= mtimecmp
+/// mtimecmp resets to all ones, so the timer is idle until programmed
+///
+
+module timer
+    // Import Constants
+    import common::*;
+    (
+        // Clocks
+        input  wire logic       clk_i,
+        output wire logic       interrupt_o,    // mtime >= mtimecmp
+
+        // Time
+        output wire dword_t     mtime_o,        // current time
+        output wire dword_t     mtimecmp_o,     // current deadline
+        input  wire logic       warp_i,         // jump mtime forward to mtimecmp (simulation only)
+
+        // Bus Interface
+        input  wire logic       chip_select_i,
+        input  wire logic [3:0] addr_i,
+        input  wire logic       read_enable_i,
+        output wire word_t      read_data_o,
+        input  wire word_t      write_data_i,
+        input  wire logic [3:0] write_mask_i
+    );
+
+typedef enum logic [3:0] {
+    PORT_MTIME     = 4'b0000,
+    PORT_MTIMEH    = 4'b0001,
+    PORT_MTIMECMP  = 4'b0010,
+    PORT_MTIMECMPH = 4'b0011
+} port_t;
+
+dword_t mtime_r    = '0;
+dword_t mtimecmp_r = '1;
+assign  mtime_o    = mtime_r;
+assign  mtimecmp_o = mtimecmp_r;
+
+logic  interrupt_r = '0;
+assign interrupt_o = interrupt_r;
+always_ff @(posedge clk_i) begin
+    interrupt_r <= mtime_r >= mtimecmp_r;
+end
+
+// writes replace the selected bytes of a word, everything else counts
+function automatic word_t merge(word_t value, word_t data, logic [3:0] mask);
+    for (int b=0; b<4; b++)
+        if (mask[b])
+            value[b*8 +: 8] = data[b*8 +: 8];
+    return value;
+endfunction
+
+always_ff @(posedge clk_i) begin
+    if (chip_select_i && addr_i == PORT_MTIME && write_mask_i != 4'b0000)
+        mtime_r <= { mtime_r[63:32], merge(mtime_r[31:0], write_data_i, write_mask_i) };
+    else if (chip_select_i && addr_i == PORT_MTIMEH && write_mask_i != 4'b0000)
+        mtime_r <= { merge(mtime_r[63:32], write_data_i, write_mask_i), mtime_r[31:0] };
+    else if (warp_i && mtimecmp_r > mtime_r)
+        mtime_r <= mtimecmp_r;
+    else
+        mtime_r <= mtime_r + 1;
+
+    if (chip_select_i && addr_i == PORT_MTIMECMP)
+        mtimecmp_r <= { mtimecmp_r[63:32], merge(mtimecmp_r[31:0], write_data_i, write_mask_i) };
+    else if (chip_select_i && addr_i == PORT_MTIMECMPH)
+        mtimecmp_r <= { merge(mtimecmp_r[63:32], write_data_i, write_mask_i), mtimecmp_r[31:0] };
+end
+
+word_t read_data_r = '0;
+assign read_data_o = read_data_r;
+always_ff @(posedge clk_i) begin
+    if (chip_select_i && read_enable_i) begin
+        case (addr_i)
+        PORT_MTIME:     read_data_r <= mtime_r[31:0];
+        PORT_MTIMEH:    read_data_r <= mtime_r[63:32];
+        PORT_MTIMECMP:  read_data_r <= mtimecmp_r[31:0];
+        PORT_MTIMECMPH: read_data_r <= mtimecmp_r[63:32];
+        default:        read_data_r <= 32'b0;
+        endcase
+    end
+end
+
+endmodule
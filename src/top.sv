@@ -8,6 +8,7 @@
 module top
     // Import Constants
     import common::*;
+    import cpu_common::*;
     (
 `ifdef USE_EXTERNAL_CLOCKS
         // Clocks
@@ -21,6 +22,27 @@ module top
         // Halt
         output wire logic        halt_o,         // halt output
 
+`ifdef ENABLE_PROBES
+        // Debug Probes
+        output wire logic [ 2:0] probe_irq_source_o,      // device interrupt lines { switches, keyboard, uart }
+        output wire logic        probe_irq_pending_o,     // interrupt controller output (mip.MEIP)
+        output wire logic        probe_irq_taken_o,       // interrupt accepted by the cpu
+        output wire logic [31:0] probe_decode_pc_o,       // program counter issuing (NOP_PC if none)
+        output wire logic [31:0] probe_decode_pc2_o,      // program counter of a pair's second instruction issuing with it (NOP_PC if none)
+        output wire logic        probe_decode_ready_o,    // issue not stalled
+        output wire logic [ 2:0] probe_stall_o,           // issue stall cause (stall_t)
+        output wire logic        probe_jump_o,            // RR redirecting fetch
+        output wire logic [31:0] probe_retire_pc_o,       // program counter retiring (NOP_PC if none)
+        output wire logic [31:0] probe_events_o,          // performance counter events (hpm_events_t)
+        output wire logic [31:0] probe_bus_addr_o,        // data bus address
+        output wire logic        probe_bus_read_enable_o, // data bus read enable
+        output wire logic [ 3:0] probe_bus_write_mask_o,  // data bus write mask
+        output wire logic [ 9:0] probe_bus_chip_select_o, // data bus chip select
+        output wire logic [63:0] probe_mtime_o,           // timer mtime
+        output wire logic [63:0] probe_mtimecmp_o,        // timer mtimecmp
+        input  wire logic        probe_timer_warp_i,      // jump mtime forward to mtimecmp (lets a sleeping core skip ahead)
+`endif
+
         // PS/2
         input  wire logic        ps2_clk_i,      // PS2 HID clock (async)
         input  wire logic        ps2_data_i,     // PS2 HID data (async)
@@ -67,27 +89,40 @@ clk_gen clk_gen (
 //
 
 wire logic         interrupt;
+wire logic         timer_interrupt;
+wire dword_t       mtime;
+wire dword_t       mtimecmp;
 wire word_t        imem_addr;
+wire logic         imem_read_enable;
 wire word_t        imem_data;
+logic              imem_valid_r = 1'b0;
 wire chip_select_t chip_select;
 wire word_t        bus_addr;
      word_t        bus_read_data;
 wire logic         bus_read_enable;
 wire word_t        bus_write_data;
 wire logic [3:0]   bus_write_mask;
+logic              bus_read_valid_r = 1'b0;
+wire probe_t       probe;
 
 chipset chipset (
     .clk_i              (cpu_clk_i),
     .interrupt_i        (interrupt),
+    .timer_interrupt_i  (timer_interrupt),
+    .mtime_i            (mtime),
     .halt_o             (halt_o),
     .imem_addr_o        (imem_addr),
+    .imem_read_enable_o (imem_read_enable),
     .imem_data_i        (imem_data),
+    .imem_valid_i       (imem_valid_r),
     .bus_chip_select_o  (chip_select),
     .bus_addr_o         (bus_addr),
     .bus_read_data_i    (bus_read_data),
     .bus_read_enable_o  (bus_read_enable),
     .bus_write_data_o   (bus_write_data),
-    .bus_write_mask_o   (bus_write_mask)
+    .bus_write_mask_o   (bus_write_mask),
+    .bus_read_valid_i   (bus_read_valid_r),
+    .probe_o            (probe)
 );
 
 
@@ -106,9 +141,12 @@ wire word_t sw_read_data;
 wire word_t uart_read_data;
 wire word_t irq_read_data;
 wire word_t vga_read_data;
+wire word_t timer_read_data;
 
+// data reads take one cycle
 always_ff @(posedge cpu_clk_i) begin
-    chip_select_r <= chip_select;
+    chip_select_r    <= chip_select;
+    bus_read_valid_r <= bus_read_enable;
 end
 
 always_comb begin
@@ -130,6 +168,8 @@ always_comb begin
         bus_read_data = irq_read_data;
     else if (chip_select_r.vga)
         bus_read_data = vga_read_data;
+    else if (chip_select_r.timer)
+        bus_read_data = timer_read_data;
     else
         bus_read_data = 32'b0;
 end
@@ -142,7 +182,7 @@ end
 // BIOS
 bios_rom #(.CONTENTS("bios.mem")) bios (
     .clk_i             (cpu_clk_i),
-    .read1_enable_i    (1'b1),
+    .read1_enable_i    (imem_read_enable),
     .read1_addr_i      (imem_addr),
     .read1_data_o      (imem_data),
     .read2_enable_i    (chip_select.bios),
@@ -150,6 +190,11 @@ bios_rom #(.CONTENTS("bios.mem")) bios (
     .read2_data_o      (bios_read_data)
 );
 
+// instruction reads take one cycle
+always_ff @(posedge cpu_clk_i) begin
+    imem_valid_r <= imem_read_enable;
+end
+
 // RAM
 system_ram ram (
     .clk_i             (cpu_clk_i),
@@ -272,5 +317,51 @@ vga_controller vga (
     .write_mask_i      (bus_write_mask)
 );
 
+// Timer
+logic timer_warp;
+`ifdef ENABLE_PROBES
+always_comb timer_warp = probe_timer_warp_i;
+`else
+always_comb timer_warp = 1'b0;
+`endif
+
+timer timer (
+    .clk_i             (cpu_clk_i),
+    .interrupt_o       (timer_interrupt),
+    .mtime_o           (mtime),
+    .mtimecmp_o        (mtimecmp),
+    .warp_i            (timer_warp),
+    .chip_select_i     (chip_select.timer),
+    .addr_i            (bus_addr[5:2]),
+    .read_enable_i     (bus_read_enable),
+    .read_data_o       (timer_read_data),
+    .write_data_i      (bus_write_data),
+    .write_mask_i      (bus_write_mask)
+);
+
+
+//
+// Debug Probes
+//
+
+`ifdef ENABLE_PROBES
+assign probe_irq_source_o      = { sw_interrupt, kbd_interrupt, uart_interrupt };
+assign probe_irq_pending_o     = interrupt;
+assign probe_irq_taken_o       = probe.irq_taken;
+assign probe_decode_pc_o       = probe.decode_pc;
+assign probe_decode_pc2_o      = probe.decode_pc2;
+assign probe_decode_ready_o    = probe.decode_ready;
+assign probe_stall_o           = probe.stall;
+assign probe_jump_o            = probe.jump;
+assign probe_retire_pc_o       = probe.retire_pc;
+assign probe_events_o          = 32'(probe.events);
+assign probe_bus_addr_o        = bus_addr;
+assign probe_bus_read_enable_o = bus_read_enable;
+assign probe_bus_write_mask_o  = bus_write_mask;
+assign probe_bus_chip_select_o = chip_select;
+assign probe_mtime_o           = mtime;
+assign probe_mtimecmp_o        = mtimecmp;
+`endif
+
 
 endmodule
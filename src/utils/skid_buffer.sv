@@ -7,6 +7,7 @@ module skid_buffer
     )
     (
         input  wire logic                  clk_i,
+        input  wire logic                  flush_i,  // discard buffered data
 
         // write port
         output      logic                  write_ready_o,
@@ -45,8 +46,8 @@ logic insert;
 logic remove;
 
 always_comb begin
-    insert = write_valid_i && write_ready_o; // insert will occur if input can be accepted, and is provided
-    remove =  read_valid_o &&  read_ready_i; // remove will occur if output can be accepted, and is provided
+    insert = write_valid_i && write_ready_o && !flush_i; // insert will occur if input can be accepted, and is provided
+    remove =  read_valid_o &&  read_ready_i;             // remove will occur if output can be accepted, and is provided
 end
 
 // which state transition is occuring
@@ -66,7 +67,9 @@ end
 
 // what will the next state be
 always_comb begin
-    priority if (load || unbuffer)
+    priority if (flush_i)
+        state_next = EMPTY;
+    else if (load || unbuffer)
         state_next = RUNNING;
     else if (buffer)
         state_next = FULL;
@@ -105,7 +108,9 @@ always_ff @(posedge clk_i) begin
     read_valid_r <= (state_next != EMPTY);
 
     // set output register
-    if (load || run)
+    if (flush_i)
+        read_data_r <= WORD_ZERO;     // discard output register
+    else if (load || run)
         read_data_r <= write_data_i;  // make input available in output register
     else if (unload)
         read_data_r <= WORD_ZERO;     // clear output buffer
@@ -113,7 +118,9 @@ always_ff @(posedge clk_i) begin
         read_data_r <= data_buffer_r; // transfer buffer to output register
 
     // set buffer register
-    if (buffer)
+    if (flush_i)
+        data_buffer_r <= WORD_ZERO;    // discard the buffer
+    else if (buffer)
         data_buffer_r <= write_data_i; // buffer the input
     else if (unbuffer)
         data_buffer_r <= WORD_ZERO;    // clear the buffer
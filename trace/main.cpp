@@ -1,46 +1,149 @@
 #include <verilated.h>
 #include <GLFW/glfw3.h>
+#include <cstdlib>
+#include <string>
 #include "verilator/Vtop.h"
 #include "sim_keyboard.h"
+#include "sim_irq_latency.h"
+#include "sim_heatmap.h"
+#include "sim_profile.h"
+#include "sim_metrics.h"
+#include "sim_input.h"
+#include "sim_idle.h"
+
+static std::string plusarg(const char *name) {
+    // verilator returns the whole "+name=value" argument, or "" if absent
+    std::string prefix = std::string(name) + "=";
+    std::string match  = Verilated::commandArgsPlusMatch(prefix.c_str());
+    return match.empty() ? "" : match.substr(prefix.size() + 1);
+}
 
 int main(int argc, char** argv)
 {
     Verilated::commandArgs(argc, argv);
 
-    sim_keyboard_t *kbd = key_create();
-    key_make (kbd, GLFW_KEY_LEFT_SHIFT);
-    key_make (kbd, GLFW_KEY_H);
-    key_break(kbd, GLFW_KEY_H);
-    key_break(kbd, GLFW_KEY_LEFT_SHIFT);
-    key_make (kbd, GLFW_KEY_E);
-    key_break(kbd, GLFW_KEY_E);
-    key_make (kbd, GLFW_KEY_L);
-    key_break(kbd, GLFW_KEY_L);
-    key_make (kbd, GLFW_KEY_L);
-    key_break(kbd, GLFW_KEY_L);
-    key_make (kbd, GLFW_KEY_O);
-    key_break(kbd, GLFW_KEY_O);
+    sim_keyboard_t *kbd   = key_create();
+    sim_input_t    *input = input_create(plusarg("record_input").c_str(), plusarg("replay_input").c_str());
+
+    // replays reproduce a sim session, so use the sim's clock ratios and run to the end of the recording
+    bool     replaying = input_replaying(input);
+    uint64_t limit     = replaying ? input_replay_end(input) : 100000;
+    uint64_t pxl_div   = replaying ? 3   : 2;
+    uint64_t ps2_div   = replaying ? 100 : 32;
+
+    if (!replaying) {
+        input_key_make (input, GLFW_KEY_LEFT_SHIFT);
+        input_key_make (input, GLFW_KEY_H);
+        input_key_break(input, GLFW_KEY_H);
+        input_key_break(input, GLFW_KEY_LEFT_SHIFT);
+        input_key_make (input, GLFW_KEY_E);
+        input_key_break(input, GLFW_KEY_E);
+        input_key_make (input, GLFW_KEY_L);
+        input_key_break(input, GLFW_KEY_L);
+        input_key_make (input, GLFW_KEY_L);
+        input_key_break(input, GLFW_KEY_L);
+        input_key_make (input, GLFW_KEY_O);
+        input_key_break(input, GLFW_KEY_O);
+    }
+
+    sim_irq_latency_t *irqlat  = irqlat_create();
+    sim_heatmap_t     *heatmap = heat_create(atoi(plusarg("heatmap_sample").c_str()));
+    sim_profile_t     *profile = prof_create();
+    sim_metrics_t     *metrics = metrics_create(plusarg("metrics").c_str(), "trace", "log.json", strtoull(plusarg("metrics_period").c_str(), NULL, 10));
+    sim_idle_t        *idle    = idle_create(0);
 
     Vtop *dut = new Vtop;
     dut->switch_i = 0x1234;
+    if (replaying) {
+        dut->cpu_clk_i = 1;
+        dut->pxl_clk_i = 1;
+    }
 
     uint64_t ncycles = 0;
 
-    while (ncycles < 100000 && !Verilated::gotFinish() && !dut->halt_o) {
+    while (ncycles < limit && !Verilated::gotFinish() && !dut->halt_o) {
         dut->eval();
 
+        // sample probes once per cpu cycle, just after the rising edge
+        if (dut->cpu_clk_i) {
+            irqlat_tick(irqlat, dut->probe_irq_source_o, dut->probe_irq_pending_o, dut->probe_irq_taken_o, dut->probe_decode_pc_o, dut->probe_bus_read_enable_o, dut->probe_bus_chip_select_o);
+            heat_tick(heatmap, dut->probe_bus_addr_o, dut->probe_bus_read_enable_o, dut->probe_bus_write_mask_o, dut->probe_bus_chip_select_o);
+            prof_tick(profile, dut->probe_decode_pc_o, dut->probe_decode_pc2_o, dut->probe_decode_ready_o, dut->probe_jump_o, dut->probe_retire_pc_o, dut->probe_events_o);
+            metrics_tick(metrics, dut->probe_decode_pc_o, dut->probe_stall_o, dut->probe_retire_pc_o, dut->probe_events_o, dut->vga_vsync_o);
+            idle_tick(idle, dut->probe_stall_o, dut->probe_irq_pending_o || dut->probe_mtime_o >= dut->probe_mtimecmp_o, key_idle(kbd), dut->vga_vsync_o);
+
+            // a warp is taken on the rising edge
+            dut->probe_timer_warp_i = 0;
+        }
+
+        // once the scripted input is consumed and the core sleeps, only the timer can wake
+        // it, so skip straight to its deadline, or stop if there is none
+        if (!replaying && idle_asleep(idle) && !input_pending(input) && key_idle(kbd) && !dut->probe_timer_warp_i) {
+            if (dut->probe_mtimecmp_o <= dut->probe_mtime_o || dut->probe_mtimecmp_o == UINT64_MAX)
+                break;
+            input_timer_warp(input);
+        }
+
         ncycles++;
 
         // update clocks
         dut->cpu_clk_i ^= 1;
-        if (ncycles % 2 == 0) { dut->pxl_clk_i ^= 1; }
+        if (ncycles % pxl_div == 0) { dut->pxl_clk_i ^= 1; }
+
+        // apply (and record) scripted input, or replay recorded input
+        uint16_t switch_i = dut->switch_i;
+        bool     warp;
+        input_tick(input, ncycles, kbd, &switch_i, &warp);
+        dut->switch_i = switch_i;
+        if (warp)
+            dut->probe_timer_warp_i = 1;
 
         // run ps2 at an absurd rate
-        if (ncycles % 32 == 0) key_tick(kbd, &dut->ps2_clk_i, &dut->ps2_data_i);
+        if (ncycles % ps2_div == 0) key_tick(kbd, &dut->ps2_clk_i, &dut->ps2_data_i);
     }
 
     dut->final();
     delete dut;
 
+    input_destroy(input, ncycles);
+    key_destroy(kbd);
+    idle_destroy(idle);
+
+    std::string irq_latency_path = plusarg("irq_latency");
+    if (!irq_latency_path.empty()) {
+        FILE *out = fopen(irq_latency_path.c_str(), "w");
+        if (out) {
+            irqlat_report(irqlat, out);
+            fclose(out);
+        }
+    }
+    irqlat_destroy(irqlat);
+
+    std::string heatmap_path = plusarg("heatmap");
+    if (!heatmap_path.empty()) {
+        FILE *out = fopen(heatmap_path.c_str(), "w");
+        if (out) {
+            heat_export(heatmap, out);
+            fclose(out);
+        }
+    }
+    heat_destroy(heatmap);
+
+    std::string profile_path     = plusarg("profile");
+    std::string profile_dis_path = plusarg("profile_dis");
+    if (profile_dis_path.empty())
+        profile_dis_path = "../roms/bios/bios.dis";
+    if (!profile_path.empty()) {
+        FILE *out = fopen(profile_path.c_str(), "w");
+        if (out) {
+            prof_report(profile, out, profile_dis_path.c_str());
+            fclose(out);
+        }
+    }
+    prof_destroy(profile);
+
+    // final metrics snapshot
+    metrics_destroy(metrics);
+
     return 0;
 }
@@ -11,5 +11,6 @@ void key_destroy(sim_keyboard_t* keyboard);
 void key_make(sim_keyboard_t* keyboard, int key);
 void key_break(sim_keyboard_t* keyboard, int key);
 void key_tick(sim_keyboard_t* keyboard, unsigned char* ps2_clk, unsigned char* ps2_data);
+bool key_idle(sim_keyboard_t* keyboard);
 
 #endif
@@ -317,25 +317,30 @@ def process(events):
         if not in_flight: continue
 
         # Decode
-        if e["stage"] == "ID" and "jmp_valid" in e and e["jmp_valid"] == "1":
-            next(f for f in in_flight if f["pc"] == int(e["pc"]) and not "decode_time" in f).update({ "jmp_addr": int(e["jmp_addr"]) })
+        if e["stage"] == "ID" and "ir" in e:
+            # print("DECODE: {0}".format(e["pc"]))
+            next(f for f in in_flight if f["pc"] == int(e["pc"]) and not "decode_time" in f).update({ "decode_time": 0 })
+
+        # Register Read
+        if e["stage"] == "RR" and "jmp_valid" in e and e["jmp_valid"] == "1":
+            next(f for f in in_flight if f["pc"] == int(e["pc"]) and not "resolve_time" in f).update({ "jmp_addr": int(e["jmp_addr"]) })
 
-        if e["stage"] == "ID" and "ready" in e and e["ready"] == "0":
+        if e["stage"] == "RR" and "ready" in e and e["ready"] == "0":
             # print("STALL: {0}".format(e["pc"]))
-            next(f for f in in_flight if f["pc"] == int(e["pc"]) and not "decode_time" in f).update({ "stall_start_time": 0 })
+            next(f for f in in_flight if f["pc"] == int(e["pc"]) and not "resolve_time" in f).update({ "stall_start_time": 0 })
 
-        if e["stage"] == "ID" and "ready" in e and e["ready"] == "1":
+        if e["stage"] == "RR" and "ready" in e and e["ready"] == "1":
             # print("RESUME: {0}".format(e["pc"]))
-            next(f for f in in_flight if f["pc"] == int(e["pc"]) and not "decode_time" in f).update({ "stall_end_time": 0 })
+            next(f for f in in_flight if f["pc"] == int(e["pc"]) and not "resolve_time" in f).update({ "stall_end_time": 0 })
 
-        if e["stage"] == "ID" and "ir" in e:
-            # print("DECODE: {0}".format(e["pc"]))
-            next(f for f in in_flight if f["pc"] == int(e["pc"]) and not "decode_time" in f).update({ "decode_time": 0 })
+        if e["stage"] == "RR" and "ir" in e:
+            # print("RESOLVE: {0}".format(e["pc"]))
+            next(f for f in in_flight if f["pc"] == int(e["pc"]) and not "resolve_time" in f).update({ "resolve_time": 0 })
 
-        if e["stage"] == "ID" and "csr_state" in e and e["csr_state"] == "1":
+        if e["stage"] == "RR" and "csr_state" in e and e["csr_state"] == "1":
             next(f for f in in_flight if f["pc"] == int(e["pc"]) and not "execute_time" in f).update({ "execute_time": 0 })
 
-        if e["stage"] == "ID" and "csr_state" in e and e["csr_state"] == "2":
+        if e["stage"] == "RR" and "csr_state" in e and e["csr_state"] == "2":
             instr = next(f for f in in_flight if f["pc"] == int(e["pc"]) and not "writeback_time" in f)
             instr.update({ "writeback_time": 0, "writeback_valid": 0, "csr_wb_enable": int(e["csr_wb_enable"]), "csr_write_enable": int(e["csr_write_enable"]), "csr_addr": int(e["csr_addr"]), "csr_read_data": int(e["csr_read_data"]), "csr_write_data": int(e["csr_write_data"]), "csr_wb_addr": int(e["csr_wb_addr"])  })
             in_flight.remove(instr)